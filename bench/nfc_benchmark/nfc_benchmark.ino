@@ -0,0 +1,336 @@
+/*
+ * NFC / ePaper Latency Benchmark
+ * Hardware: ESP32 + PN5180 NFC Reader + 3-color ePaper Display (same wiring as src/nfc_display.ino)
+ * Measures PN5180 command and activation latency at several SPI frequencies
+ * and full vs. partial ePaper refresh. Results (min/median/p99 in us) go to Serial.
+ */
+
+// ========== PIN CONFIGURATION ==========
+constexpr uint8_t PN5180_NSS_PIN = 16;    // SPI Chip Select for PN5180
+constexpr uint8_t PN5180_BUSY_PIN = 5;    // Busy pin for PN5180
+constexpr uint8_t PN5180_RST_PIN = 17;    // Reset pin for PN5180
+
+// ========== E-PAPER DISPLAY PINOUT ==========
+constexpr uint8_t EPD_CS_PIN = 15;        // Chip Select for ePaper display
+constexpr uint8_t EPD_DC_PIN = 2;         // Data/Command pin for ePaper
+constexpr uint8_t EPD_RST_PIN = 4;        // Reset pin for ePaper
+constexpr uint8_t EPD_BUSY_PIN = 13;      // Busy pin for ePaper
+
+// ========== BENCHMARK CONFIGURATION ==========
+constexpr uint16_t BENCH_SAMPLES = 200;             // Samples per PN5180 measurement
+constexpr uint8_t BENCH_EPD_SAMPLES = 3;            // Samples per ePaper refresh (seconds each)
+constexpr uint32_t BENCH_PROMPT_TIMEOUT_MS = 15000; // Wait for Enter before a card step
+constexpr uint32_t BENCH_SPI_FREQUENCIES[] = {      // PN5180 SPI clock, max 7 MHz
+    1000000, 2000000, 4000000, 7000000
+};
+
+// ========== SYSTEM INCLUDES ==========
+#include <PN5180.h>
+#include <PN5180ISO14443.h>
+#include <PN5180ISO15693.h>
+#include <SPI.h>
+#include <stdlib.h>
+
+// ========== E-PAPER DISPLAY LIBRARIES ==========
+#include <GxEPD2_3C.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+
+// ========== HARDWARE OBJECT INSTANTIATION ==========
+// ePaper Display object (3-color, 2.66-inch)
+GxEPD2_3C<GxEPD2_266c, GxEPD2_266c::HEIGHT> display(
+    GxEPD2_266c(/*CS=*/ EPD_CS_PIN,
+                /*DC=*/ EPD_DC_PIN,
+                /*RST=*/ EPD_RST_PIN,
+                /*BUSY=*/ EPD_BUSY_PIN));
+
+// NFC Reader objects, one per protocol on the same PN5180
+PN5180ISO14443 nfc14443(PN5180_NSS_PIN, PN5180_BUSY_PIN, PN5180_RST_PIN);
+PN5180ISO15693 nfc15693(PN5180_NSS_PIN, PN5180_BUSY_PIN, PN5180_RST_PIN);
+
+// ========== SAMPLE STORAGE ==========
+uint32_t samples[BENCH_SAMPLES];
+uint16_t sampleCount = 0;
+
+// ========== RESULT REPORTING ==========
+/**
+ * @brief qsort comparator for uint32_t samples
+ */
+int compareSamples(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *)a;
+    uint32_t right = *(const uint32_t *)b;
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Prints min/median/p99 of the collected samples
+ *
+ * @param name Benchmark name
+ * @param spiFrequency PN5180 SPI clock, 0 if not applicable
+ *
+ * Output is one line per benchmark, easy to diff between releases
+ */
+void reportSamples(const char *name, uint32_t spiFrequency) {
+    Serial.print(name);
+    if (spiFrequency > 0) {
+        Serial.print(" @ ");
+        Serial.print(spiFrequency / 1000);
+        Serial.print(" kHz");
+    }
+
+    if (sampleCount == 0) {
+        Serial.println(": skipped");
+        return;
+    }
+
+    qsort(samples, sampleCount, sizeof(samples[0]), compareSamples);
+    uint16_t p99Index = (sampleCount * 99 + 99) / 100 - 1; // ceil(0.99 * n) - 1
+
+    Serial.print(": min ");
+    Serial.print(samples[0]);
+    Serial.print(" us, median ");
+    Serial.print(samples[sampleCount / 2]);
+    Serial.print(" us, p99 ");
+    Serial.print(samples[p99Index]);
+    Serial.print(" us (n=");
+    Serial.print(sampleCount);
+    Serial.println(")");
+}
+
+/**
+ * @brief Stores one sample
+ *
+ * @param startedUs micros() at the start of the measured call
+ */
+void addSample(unsigned long startedUs) {
+    uint32_t elapsed = micros() - startedUs;
+    if (sampleCount < BENCH_SAMPLES) {
+        samples[sampleCount++] = elapsed;
+    }
+}
+
+/**
+ * @brief Asks the operator to prepare the reader field
+ *
+ * @param message Instruction, e.g. "Place an ISO14443A card"
+ *
+ * Continues after Enter or BENCH_PROMPT_TIMEOUT_MS
+ */
+void prompt(const char *message) {
+    Serial.println(F("----------------------------------"));
+    Serial.print(message);
+    Serial.println(F(", then press Enter..."));
+
+    while (Serial.available()) Serial.read();
+    unsigned long startedWaiting = millis();
+    while (!Serial.available() && millis() - startedWaiting < BENCH_PROMPT_TIMEOUT_MS) {
+        delay(10);
+    }
+    while (Serial.available()) Serial.read();
+}
+
+/**
+ * @brief Applies an SPI clock to both protocol objects
+ */
+void setSpiFrequency(uint32_t spiFrequency) {
+    nfc14443.setSPISettingsFrecuency(spiFrequency);
+    nfc15693.setSPISettingsFrecuency(spiFrequency);
+}
+
+// ========== PN5180 BENCHMARKS ==========
+/**
+ * @brief Register and EEPROM access, no RF involved
+ */
+void benchHostInterface(uint32_t spiFrequency) {
+    uint32_t registerValue;
+    uint8_t eepromData[2];
+
+    sampleCount = 0;
+    for (uint16_t sampleIndex = 0; sampleIndex < BENCH_SAMPLES; sampleIndex++) {
+        unsigned long started = micros();
+        nfc14443.readRegister(RF_STATUS, &registerValue);
+        addSample(started);
+    }
+    reportSamples("readRegister", spiFrequency);
+
+    sampleCount = 0;
+    for (uint16_t sampleIndex = 0; sampleIndex < BENCH_SAMPLES; sampleIndex++) {
+        unsigned long started = micros();
+        nfc14443.readEEprom(FIRMWARE_VERSION, eepromData, sizeof(eepromData));
+        addSample(started);
+    }
+    reportSamples("readEEprom", spiFrequency);
+}
+
+/**
+ * @brief ISO14443A activation, empty field or with a card
+ *
+ * @param name Benchmark name
+ * @param expectCard Only count activations that found (or did not find) a card
+ */
+void benchActivateTypeA(const char *name, uint32_t spiFrequency, bool expectCard) {
+    uint8_t response[10];
+
+    nfc14443.reset();
+    nfc14443.setupRF();
+
+    sampleCount = 0;
+    for (uint16_t sampleIndex = 0; sampleIndex < BENCH_SAMPLES; sampleIndex++) {
+        unsigned long started = micros();
+        int8_t uidLength = nfc14443.activateTypeA(response, 1); // WUPA, also wakes halted cards
+        uint32_t elapsed = micros() - started;
+
+        if ((uidLength > 0) == expectCard && sampleCount < BENCH_SAMPLES) {
+            samples[sampleCount++] = elapsed;
+        }
+        if (uidLength > 0) {
+            nfc14443.mifareHalt();
+        }
+    }
+    reportSamples(name, spiFrequency);
+}
+
+/**
+ * @brief ISO15693 inventory and block read
+ */
+void benchISO15693(uint32_t spiFrequency) {
+    uint8_t uid[8];
+    uint8_t blockSize = 0, numBlocks = 0;
+
+    nfc15693.reset();
+    nfc15693.setupRF();
+
+    sampleCount = 0;
+    bool tagFound = false;
+    for (uint16_t sampleIndex = 0; sampleIndex < BENCH_SAMPLES; sampleIndex++) {
+        unsigned long started = micros();
+        ISO15693ErrorCode rc = nfc15693.getInventory(uid);
+        if (rc == ISO15693_EC_OK) {
+            addSample(started);
+            tagFound = true;
+        }
+    }
+    reportSamples("getInventory", spiFrequency);
+
+    sampleCount = 0;
+    if (tagFound && nfc15693.getSystemInfo(uid, &blockSize, &numBlocks) == ISO15693_EC_OK) {
+        const uint8_t BLOCKS_TO_READ = 4;
+        uint8_t blockData[BLOCKS_TO_READ * 32];
+        if (numBlocks >= BLOCKS_TO_READ && blockSize <= 32) {
+            for (uint16_t sampleIndex = 0; sampleIndex < BENCH_SAMPLES; sampleIndex++) {
+                unsigned long started = micros();
+                ISO15693ErrorCode rc = nfc15693.readMultipleBlock(uid, 0, BLOCKS_TO_READ,
+                                                                  blockData, blockSize);
+                if (rc == ISO15693_EC_OK) {
+                    addSample(started);
+                }
+            }
+        }
+    }
+    reportSamples("readMultipleBlock (4 blocks)", spiFrequency);
+}
+
+// ========== E-PAPER BENCHMARKS ==========
+/**
+ * @brief Full window vs. partial window (one text band) refresh
+ *
+ * Uses the ePaper's own SPI settings, independent of the PN5180 clock
+ */
+void benchDisplay() {
+    const uint16_t BAND_Y = 60;
+    const uint16_t BAND_HEIGHT = 32;
+
+    sampleCount = 0;
+    for (uint8_t sampleIndex = 0; sampleIndex < BENCH_EPD_SAMPLES; sampleIndex++) {
+        display.setFullWindow();
+        display.fillScreen(GxEPD_WHITE);
+        display.fillRect(0, 0, display.width(), 50, GxEPD_RED);
+
+        unsigned long started = micros();
+        display.display(false);
+        addSample(started);
+    }
+    reportSamples("ePaper full refresh", 0);
+
+    sampleCount = 0;
+    for (uint8_t sampleIndex = 0; sampleIndex < BENCH_EPD_SAMPLES; sampleIndex++) {
+        unsigned long started = micros();
+        display.setPartialWindow(0, BAND_Y, display.width(), BAND_HEIGHT);
+        display.firstPage();
+        do {
+            display.fillScreen(GxEPD_WHITE);
+            display.setFont(&FreeMonoBold12pt7b);
+            display.setTextColor(GxEPD_BLACK);
+            display.setCursor(20, BAND_Y + 22);
+            display.print("Sample ");
+            display.print(sampleIndex);
+        } while (display.nextPage());
+        addSample(started);
+    }
+    reportSamples("ePaper partial refresh", 0);
+}
+
+// ========== ARDUINO SETUP FUNCTION ==========
+/**
+ * @brief Runs all benchmarks once
+ */
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println(F("=================================="));
+    Serial.println(F("PN5180 / ePaper Latency Benchmark"));
+    Serial.println(F("=================================="));
+
+    // ========== SPI BUS INITIALIZATION ==========
+    SPI.begin(18, 19, 23); // SCK, MISO, MOSI pins
+
+    // ========== NFC READER INITIALIZATION ==========
+    // PN5180 NSS high before the first ePaper transfer
+    nfc14443.begin();
+
+    // ========== DISPLAY INITIALIZATION ==========
+    display.init(115200, true, 2, false);
+    display.setRotation(1);
+
+    nfc14443.reset();
+
+    uint8_t productVersion[2];
+    nfc14443.readEEprom(PRODUCT_VERSION, productVersion, sizeof(productVersion));
+    if (0xff == productVersion[1]) {
+        Serial.println(F("PN5180 not found, check wiring"));
+        return;
+    }
+
+    // ========== PN5180 BENCHMARKS ==========
+    prompt("Remove all cards from the reader");
+    for (uint32_t spiFrequency : BENCH_SPI_FREQUENCIES) {
+        setSpiFrequency(spiFrequency);
+        benchHostInterface(spiFrequency);
+        benchActivateTypeA("activateTypeA (no card)", spiFrequency, false);
+    }
+
+    prompt("Place an ISO14443A card on the reader");
+    for (uint32_t spiFrequency : BENCH_SPI_FREQUENCIES) {
+        setSpiFrequency(spiFrequency);
+        benchActivateTypeA("activateTypeA (card)", spiFrequency, true);
+    }
+
+    prompt("Place an ISO15693 tag on the reader");
+    for (uint32_t spiFrequency : BENCH_SPI_FREQUENCIES) {
+        setSpiFrequency(spiFrequency);
+        benchISO15693(spiFrequency);
+    }
+
+    // ========== E-PAPER BENCHMARKS ==========
+    Serial.println(F("----------------------------------"));
+    benchDisplay();
+
+    Serial.println(F("----------------------------------"));
+    nfc14443.printStats(Serial);
+    Serial.println(F("Benchmark done."));
+}
+
+// ========== ARDUINO MAIN LOOP ==========
+void loop() {
+    delay(1000);
+}
@@ -38,8 +38,6 @@
 #define PN5180_RF_ON                    (0x16)
 #define PN5180_RF_OFF                   (0x17)
 
-uint8_t PN5180::readBufferStatic16[16];
-
 PN5180::PN5180(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi) :
   PN5180_NSS(SSpin),
   PN5180_BUSY(BUSYpin),
@@ -57,6 +55,7 @@ PN5180::PN5180(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi) :
    */
   // Settings for PN5180: 7Mbps, MSB first, SPI_MODE0 (CPOL=0, CPHA=0)
   SPI_SETTINGS = SPISettings(7000000, MSBFIRST, SPI_MODE0);
+  resetStats();
 }
 
 PN5180::~PN5180() {
@@ -246,13 +245,10 @@ bool PN5180::writeEEprom(uint8_t addr, const uint8_t *buffer, uint8_t len) {
   PN5180DEBUG_PRINTF(F("PN5180::writeEEprom(addr=%s, *buffer, len=%d)"), formatHex(addr), len);
   PN5180DEBUG_PRINTLN();
   PN5180DEBUG_ENTER;
-  uint8_t cmd[len + 2];
-  cmd[0] = PN5180_WRITE_EEPROM;
-  cmd[1] = addr;
-  for (int i = 0; i < len; i++) cmd[2 + i] = buffer[i];
-  transceiveCommand(cmd, len + 2);
+  uint8_t header[] = { PN5180_WRITE_EEPROM, addr };
+  bool ret = transceivePayload(header, sizeof(header), buffer, len);
   PN5180DEBUG_EXIT;
-  return true;
+  return ret;
 }
 
 /*
@@ -336,15 +332,14 @@ bool PN5180::sendData(const uint8_t *data, int len, uint8_t validBits) {
   PN5180DEBUG_PRINTLN();
 #endif
 
-  uint8_t buffer[len+2];
-  buffer[0] = PN5180_SEND_DATA;
-  buffer[1] = validBits; // number of valid bits of last byte are transmitted (0 = all bits are transmitted)
-  for (int i=0; i<len; i++) {
-    buffer[2+i] = data[i];
-  }
+  uint8_t header[2];
+  header[0] = PN5180_SEND_DATA;
+  header[1] = validBits; // number of valid bits of last byte are transmitted (0 = all bits are transmitted)
 
-  writeRegisterWithAndMask(SYSTEM_CONFIG, 0xfffffff8);  // Idle/StopCom Command
-  writeRegisterWithOrMask(SYSTEM_CONFIG, 0x00000003);   // Transceive Command
+  uint32_t rfStatus = 0;
+  PN5180CommandQueue queue;
+  queue.writeRegisterWithAndMask(SYSTEM_CONFIG, 0xfffffff8);  // Idle/StopCom Command
+  queue.writeRegisterWithOrMask(SYSTEM_CONFIG, 0x00000003);   // Transceive Command
   /*
    * Transceive command; initiates a transceive cycle.
    * Note: Depending on the value of the Initiator bit, a
@@ -353,15 +348,21 @@ bool PN5180::sendData(const uint8_t *data, int len, uint8_t validBits) {
    * automatically. It stays in the transceive cycle until
    * stopped via the IDLE/StopCom command
    */
+  queue.readRegister(RF_STATUS, &rfStatus);                   // TRANSCEIVE_STATE
+  if (!execute(queue)) {
+    PN5180DEBUG_EXIT;
+    return false;
+  }
 
-  PN5180TransceiveStat transceiveState = getTransceiveState();
+  PN5180TransceiveStat transceiveState = PN5180TransceiveStat((rfStatus >> 24) & 0x07);
   if (PN5180_TS_WaitTransmit != transceiveState) {
     PN5180DEBUG_PRINTLN(F("*** ERROR: Transceiver not in state WaitTransmit!?"));
     PN5180DEBUG_EXIT;
     return false;
   }
 
-  bool ret = transceiveCommand(buffer, len+2);
+  // the payload is sent from the caller's buffer
+  bool ret = transceivePayload(header, sizeof(header), data, len);
   PN5180DEBUG_EXIT;
   return ret;
 }
@@ -396,7 +397,7 @@ uint8_t * PN5180::readData(int len) {
   uint8_t *readBuffer;
   if (len <=16) {
     // use a smaller static buffer, e.g. if reading the uid only
-    readBuffer = readBufferStatic16;
+    readBuffer = readBuffer16;
   } else {
     // allocate the max buffer length of 508 bytes
     if (!readBufferDynamic508) {
@@ -439,68 +440,136 @@ bool PN5180::readData(int len, uint8_t *buffer) {
   return ret;
 }
 
-/* prepare LPCD registers (Low Power Card Detection) */
+/*
+ * Read the reception buffer into two buffers with one READ_DATA command,
+ * the first headerLen bytes into header, the next len bytes into buffer.
+ */
+bool PN5180::readData(uint8_t *header, int headerLen, uint8_t *buffer, int len) {
+  PN5180DEBUG_PRINTF(F("PN5180::readData(*header, headerLen=%d, *buffer, len=%d)"), headerLen, len);
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+
+  if (headerLen <= 0 || len < 0 || headerLen + len > 625) {
+    PN5180DEBUG_EXIT;
+    return false;
+  }
+  uint8_t cmd[] = { PN5180_READ_DATA, 0x00 };
+  bool ret = transceiveCommand(cmd, sizeof(cmd), header, headerLen, buffer, len);
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
+/* prepare LPCD registers (Low Power Card Detection) with default values */
 bool PN5180::prepareLPCD() {
-  //=======================================LPCD CONFIG================================================================================
-  PN5180DEBUG(F("----------------------------------"));
-  PN5180DEBUG(F("prepare LPCD..."));
-
-  uint8_t data[255];
-  uint8_t response[256];
-    //1. Set Fieldon time                                           LPCD_FIELD_ON_TIME (0x36)
-  uint8_t fieldOn = 0xF0;//0x## -> ##(base 10) x 8μs + 62 μs
-  data[0] = fieldOn;
-  writeEEprom(0x36, data, 1);
-  readEEprom(0x36, response, 1);
-  fieldOn = response[0];
-  PN5180DEBUG("LPCD-fieldOn time: ");
-  PN5180DEBUG(formatHex(fieldOn));
-
-    //2. Set threshold level                                         AGC_LPCD_THRESHOLD @ EEPROM 0x37
-  uint8_t threshold = 0x03;
-  data[0] = threshold;
-  writeEEprom(0x37, data, 1);
-  readEEprom(0x37, response, 1);
-  threshold = response[0];
-  PN5180DEBUG("LPCD-threshold: ");
-  PN5180DEBUG(formatHex(threshold));
-
-  //3. Select LPCD mode                                               LPCD_REFVAL_GPO_CONTROL (0x38)
-  uint8_t lpcdMode = 0x01; // 1 = LPCD SELF CALIBRATION 
-                           // 0 = LPCD AUTO CALIBRATION (this mode does not work, should look more into it, no reason why it shouldn't work)
-  data[0] = lpcdMode;
-  writeEEprom(0x38, data, 1);
-  readEEprom(0x38, response, 1);
-  lpcdMode = response[0];
-  PN5180DEBUG("lpcdMode: ");
-  PN5180DEBUG(formatHex(lpcdMode));
-  
-  // LPCD_GPO_TOGGLE_BEFORE_FIELD_ON (0x39)
-  uint8_t beforeFieldOn = 0xF0; 
-  data[0] = beforeFieldOn;
-  writeEEprom(0x39, data, 1);
-  readEEprom(0x39, response, 1);
-  beforeFieldOn = response[0];
-  PN5180DEBUG("beforeFieldOn: ");
-  PN5180DEBUG(formatHex(beforeFieldOn));
-  
-  // LPCD_GPO_TOGGLE_AFTER_FIELD_ON (0x3A)
-  uint8_t afterFieldOn = 0xF0; 
-  data[0] = afterFieldOn;
-  writeEEprom(0x3A, data, 1);
-  readEEprom(0x3A, response, 1);
-  afterFieldOn = response[0];
-  PN5180DEBUG("afterFieldOn: ");
-  PN5180DEBUG(formatHex(afterFieldOn));
-  delay(100);
+  return prepareLPCD(PN5180LPCDConfig());
+}
+
+/*
+ * prepare LPCD registers (Low Power Card Detection)
+ * The EEPROM is only written if the configuration differs from its content,
+ * the (cached) configuration is read back once with a single READ_EEPROM.
+ */
+bool PN5180::prepareLPCD(const PN5180LPCDConfig &config) {
+  PN5180DEBUG_PRINTLN(F("PN5180::prepareLPCD(config)"));
+  PN5180DEBUG_ENTER;
+
+  uint8_t wanted[5] = {
+    config.fieldOnTime,            // LPCD_FIELD_ON_TIME (0x36)
+    config.threshold,              // LPCD_THRESHOLD (0x37)
+    config.refValGpoControl,       // LPCD_REFVAL_GPO_CONTROL (0x38)
+    config.gpoToggleBeforeFieldOn, // LPCD_GPO_TOGGLE_BEFORE_FIELD_ON (0x39)
+    config.gpoToggleAfterFieldOn   // LPCD_GPO_TOGGLE_AFTER_FIELD_ON (0x3A)
+  };
+
+  uint8_t current[5];
+  if (lpcdConfigValid) {
+    current[0] = lpcdConfig.fieldOnTime;
+    current[1] = lpcdConfig.threshold;
+    current[2] = lpcdConfig.refValGpoControl;
+    current[3] = lpcdConfig.gpoToggleBeforeFieldOn;
+    current[4] = lpcdConfig.gpoToggleAfterFieldOn;
+  }
+  else if (!readEEprom(LPCD_FIELD_ON_TIME, current, sizeof(current))) {
+    PN5180DEBUG_EXIT;
+    return false;
+  }
+
+  // write the changed range only, to save EEPROM cycles
+  int first = -1, last = -1;
+  for (int i=0; i<5; i++) {
+    if (current[i] != wanted[i]) {
+      if (first < 0) first = i;
+      last = i;
+    }
+  }
+  if (first >= 0) {
+    PN5180DEBUG_PRINTF(F("LPCD: update EEPROM 0x%s"), formatHex(uint8_t(LPCD_FIELD_ON_TIME + first)));
+    PN5180DEBUG_PRINTLN();
+    if (!writeEEprom(LPCD_FIELD_ON_TIME + first, &wanted[first], last - first + 1)) {
+      lpcdConfigValid = false;
+      PN5180DEBUG_EXIT;
+      return false;
+    }
+  }
+
+  lpcdConfig = config;
+  lpcdConfigValid = true;
+  PN5180DEBUG_EXIT;
   return true;
 }
 
+/*
+ * Calibrate the LPCD threshold for the installed antenna.
+ * With the RF field on and no card present, the AGC value is sampled
+ * 'samples' times. The threshold is set to the measured noise (max-min)
+ * plus 'margin' and stored with prepareLPCD(), so EEPROM is only written
+ * if the result changed.
+ */
+bool PN5180::calibrateLPCD(PN5180LPCDConfig &config, uint8_t samples, uint8_t margin) {
+  PN5180DEBUG_PRINTF(F("PN5180::calibrateLPCD(config, samples=%d, margin=%d)"), samples, margin);
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+
+  if (0 == samples) samples = 1;
+
+  uint16_t agcMin = 0x3FF, agcMax = 0;
+  for (uint8_t i=0; i<samples; i++) {
+    uint32_t agc;
+    if (!readRegister(AGC_VALUE, &agc)) {
+      PN5180DEBUG_EXIT;
+      return false;
+    }
+    uint16_t value = agc & 0x03FF;  // AGC_VALUE bits 9..0
+    if (value < agcMin) agcMin = value;
+    if (value > agcMax) agcMax = value;
+    delayMicroseconds(500);
+  }
+
+  uint16_t threshold = (agcMax - agcMin) + margin;
+  if (threshold < 0x03) threshold = 0x03;  // very sensitive
+  if (threshold > 0x50) threshold = 0x50;  // very robust
+  config.threshold = (uint8_t)threshold;
+
+  PN5180DEBUG(F("LPCD: AGC min=0x"));
+  PN5180DEBUG(formatHex(agcMin));
+  PN5180DEBUG(F(", max=0x"));
+  PN5180DEBUG(formatHex(agcMax));
+  PN5180DEBUG(F(", threshold=0x"));
+  PN5180DEBUG(formatHex(config.threshold));
+  PN5180DEBUG_PRINTLN();
+
+  bool ret = prepareLPCD(config);
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
 /* switch the mode to LPCD (low power card detection)
  * Parameter 'wakeupCounterInMs' must be in the range from 0x0 - 0xA82
  * max. wake-up time is 2960 ms.
  */
 bool PN5180::switchToLPCD(uint16_t wakeupCounterInMs) {
+  // the PN5180 switches off the RF field in LPCD
+  invalidateRFState();
   // clear all IRQ flags
   clearIRQStatus(0xffffffff); 
   // enable only LPCD and general error IRQ
@@ -535,6 +604,7 @@ int16_t PN5180::mifareAuthenticate(uint8_t blockNo, const uint8_t *key, uint8_t
   }
 
   bool retval = transceiveCommand(cmdBuffer, 13, rcvBuffer, 1);
+  protocolPrepared = false;  // crypto may be enabled now
 
   if (!retval){
     PN5180DEBUG_PRINTLN(F("*** ERROR: sending command failed!"));
@@ -573,7 +643,14 @@ bool PN5180::loadRFConfig(uint8_t txConf, uint8_t rxConf) {
 
   uint8_t cmd[] = { PN5180_LOAD_RF_CONFIG, txConf, rxConf };
 
-  transceiveCommand(cmd, sizeof(cmd));
+  if (!transceiveCommand(cmd, sizeof(cmd))) {
+    PN5180DEBUG_EXIT;
+    return false;
+  }
+  // 0xFF leaves the configuration unchanged
+  if (0xFF != txConf) rfTxConfig = txConf;
+  if (0xFF != rxConf) rfRxConfig = rxConf;
+  protocolPrepared = false;
 
   PN5180DEBUG_EXIT;
   return true;
@@ -608,6 +685,7 @@ bool PN5180::setRF_on() {
   PN5180DEBUG_ON;
   
   clearIRQStatus(TX_RFON_IRQ_STAT);
+  rfFieldOn = true;
   PN5180DEBUG_EXIT;
   return true;
 }
@@ -624,6 +702,7 @@ bool PN5180::setRF_off() {
   uint8_t cmd[] { PN5180_RF_OFF, 0x00 };
 
   transceiveCommand(cmd, sizeof(cmd));
+  rfFieldOn = false;
 
   unsigned long startedWaiting = millis();
   PN5180DEBUG_PRINTLN(F("wait for RF field to shut down (max 500ms)"));
@@ -644,6 +723,46 @@ bool PN5180::setRF_off() {
   return true;
 }
 
+/*
+ * Error recovery, one tier per call: the caller escalates from the cheap
+ * tiers to the hard reset on repeated failures. The RF configuration is
+ * restored by the next activation. Each call is counted in the statistics.
+ */
+bool PN5180::recover(PN5180Recovery tier) {
+  PN5180DEBUG_PRINTF(F("PN5180::recover(tier=%d)"), tier);
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+
+  if (tier >= PN5180_RECOVERY_COUNT) {
+    PN5180DEBUG_EXIT;
+    return false;
+  }
+  stats.recoveryCount[tier]++;
+  // CRC and crypto state are unknown after a failed transaction
+  protocolPrepared = false;
+
+  bool ret = true;
+  switch (tier) {
+    case PN5180_RECOVERY_IDLE: {
+      PN5180CommandQueue queue;
+      queue.writeRegisterWithAndMask(SYSTEM_CONFIG, 0xfffffff8);  // Idle/StopCom Command
+      queue.writeRegister(IRQ_CLEAR, 0xffffffff);
+      ret = execute(queue);
+      break;
+    }
+    case PN5180_RECOVERY_RF_CYCLE:
+      ret = setRF_off();
+      break;
+    case PN5180_RECOVERY_RESET:
+      reset();
+      break;
+    default:
+      break;
+  }
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
 //---------------------------------------------------------------------------------------------
 
 /*
@@ -682,11 +801,51 @@ status register contain information on the exception.
  * 5. Wait until BUSY is low
  * If there is a parameter error, the IRQ is set to ACTIVE and a GENERAL_ERROR_IRQ is set.
  */
-bool PN5180::transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer, size_t recvBufferLen) {
+bool PN5180::transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer, size_t recvBufferLen,
+                               uint8_t *recvBuffer2, size_t recvBuffer2Len) {
   PN5180DEBUG_PRINTF(F("PN5180::transceiveCommand(*sendBuffer, sendBufferLen=%d, *recvBuffer, recvBufferLen=%d)"), sendBufferLen, recvBufferLen);
   PN5180DEBUG_PRINTLN();
   PN5180DEBUG_ENTER;
+  beginBus();
+  bool ret = transceiveFrames(sendBuffer, sendBufferLen, recvBuffer, recvBufferLen, recvBuffer2, recvBuffer2Len);
+  endBus();
+  if (!ret) {
+    // restore state of SS in case of an error
+    digitalWrite(PN5180_NSS, HIGH);
+  }
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
+/*
+ * Bus arbitration with other devices (ePaper, further PN5180) on the same
+ * SPI bus: lock is called before and unlock after every SPI transaction
+ * of this instance, e.g. with a mutex shared by all users of the bus.
+ */
+void PN5180::setBusLock(PN5180BusLockFn lock, PN5180BusLockFn unlock, void *context) {
+  busLock = lock;
+  busUnlock = unlock;
+  busLockContext = context;
+}
+
+void PN5180::beginBus() {
+  if (busLock) busLock(busLockContext);
   PN5180_SPI.beginTransaction(SPI_SETTINGS);
+}
+
+void PN5180::endBus() {
+  PN5180_SPI.endTransaction();
+  if (busUnlock) busUnlock(busLockContext);
+}
+
+/*
+ * Send (and receive) the SPI frames of one host interface command,
+ * called within an SPI transaction. Returns false on a BUSY timeout.
+ * The receive frame is split into recvBuffer and (optional) recvBuffer2,
+ * e.g. a response header and the payload in the caller's buffer.
+ */
+bool PN5180::transceiveFrames(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer, size_t recvBufferLen,
+                              uint8_t *recvBuffer2, size_t recvBuffer2Len) {
 #ifdef DEBUG
   PN5180DEBUG(F("Sending SPI frame: '"));
   for (uint8_t i=0; i<sendBufferLen; i++) {
@@ -696,89 +855,39 @@ bool PN5180::transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_
   PN5180DEBUG_PRINTLN("'");
 #endif
 
-  // 0.
-  unsigned long startedWaiting = millis();
-  while (LOW != digitalRead(PN5180_BUSY)) {
-	  delay(1);
-	  if (millis() - startedWaiting > commandTimeout) {
-		  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/0)");
-		  PN5180_SPI.endTransaction();
-		  digitalWrite(PN5180_NSS, HIGH);
-		  PN5180DEBUG_EXIT;
-		  return false;
-	  };
-  }; // wait until busy is low
-  // 1.
-  digitalWrite(PN5180_NSS, LOW); delay(1);
-  // 2.
-  PN5180_SPI.transfer((uint8_t*)sendBuffer, sendBufferLen);  
-  // 3.
-  startedWaiting = millis();
-  while (HIGH != digitalRead(PN5180_BUSY)) {
-	  delay(1);
-	  if (millis() - startedWaiting > commandTimeout) {
-		  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/3)");
-		  PN5180_SPI.endTransaction();
-		  digitalWrite(PN5180_NSS, HIGH);
-		  PN5180DEBUG_EXIT;
-		  return false;
-	  };
-  }; // wait until busy is high
-  // 4.
-  digitalWrite(PN5180_NSS, HIGH); delay(1);
-  // 5.
-  startedWaiting = millis();
-  while (LOW != digitalRead(PN5180_BUSY)) {
-	  delay(1);
-	  if (millis() - startedWaiting > commandTimeout) {
-		  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/5)");
-		  PN5180_SPI.endTransaction();
-		  digitalWrite(PN5180_NSS, HIGH);
-		  PN5180DEBUG_EXIT;
-		  return false;
-	  };
-  }; // wait until busy is low
+  unsigned long startedCommand = micros();
+  uint8_t opcode = sendBuffer[0];
+
+  if (!sendFrame(sendBuffer, sendBufferLen, 0, 0)) {
+    return recordCommand(opcode, startedCommand, false);
+  }
 
   // check, if write-only
   if ((0 == recvBuffer) || (0 == recvBufferLen)) {
-    PN5180_SPI.endTransaction();
-    digitalWrite(PN5180_NSS, HIGH);
-    PN5180DEBUG_EXIT;
-    return true;
+    return recordCommand(opcode, startedCommand, true);
   }
   PN5180DEBUG_PRINTLN(F("Receiving SPI frame..."));
 
   // 1.
   digitalWrite(PN5180_NSS, LOW); 
   // 2.
-  memset(recvBuffer, 0xFF, recvBufferLen);
-  PN5180_SPI.transfer(recvBuffer, recvBufferLen);
+  spiRead(recvBuffer, recvBufferLen);
+  if ((0 != recvBuffer2) && (recvBuffer2Len > 0)) {
+    spiRead(recvBuffer2, recvBuffer2Len);
+  }
   // 3.
-  startedWaiting = millis(); //delay(1);
-  while (HIGH != digitalRead(PN5180_BUSY)) {
-	  delay(1);
-	  if (millis() - startedWaiting > commandTimeout) {
-		  PN5180DEBUG("*** ERROR: transceiveCommand timeout (receive/3)");
-		  PN5180_SPI.endTransaction();
-		  digitalWrite(PN5180_NSS, HIGH);
-		  PN5180DEBUG_EXIT;
-		  return false;
-	  };
+  if (!waitForBusy(HIGH)) {
+	  PN5180DEBUG("*** ERROR: transceiveCommand timeout (receive/3)");
+	  return recordCommand(opcode, startedCommand, false);
   }; // wait until busy is high
   // 4.
   digitalWrite(PN5180_NSS, HIGH); 
   // 5.
-  startedWaiting = millis();
-  while (LOW != digitalRead(PN5180_BUSY)) {
-	  delay(1);
-	  if (millis() - startedWaiting > commandTimeout) {
-		  PN5180DEBUG("*** ERROR: transceiveCommand timeout (receive/5)");
-		  PN5180_SPI.endTransaction();
-		  digitalWrite(PN5180_NSS, HIGH);
-		  PN5180DEBUG_EXIT;
-		  return false;
-	  };
+  if (!waitForBusy(LOW)) {
+	  PN5180DEBUG("*** ERROR: transceiveCommand timeout (receive/5)");
+	  return recordCommand(opcode, startedCommand, false);
   }; // wait until busy is low
+  recordCommand(opcode, startedCommand, true);
 
 #ifdef DEBUG
   PN5180DEBUG(F("Received: '"));
@@ -788,8 +897,200 @@ bool PN5180::transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_
   }
   PN5180DEBUG_PRINTLN("'");
 #endif
-  PN5180_SPI.endTransaction();
+  return true;
+}
+
+/*
+ * Write-only host interface command, header and payload are sent in one
+ * SPI frame straight from their buffers, e.g. SEND_DATA without a copy.
+ */
+bool PN5180::transceivePayload(const uint8_t *header, size_t headerLen, const uint8_t *payload, size_t payloadLen) {
+  PN5180DEBUG_PRINTF(F("PN5180::transceivePayload(*header, headerLen=%d, *payload, payloadLen=%d)"), (int)headerLen, (int)payloadLen);
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+
+  unsigned long startedCommand = micros();
+  uint8_t opcode = header[0];
+  beginBus();
+  bool ret = sendFrame(header, headerLen, payload, payloadLen);
+  endBus();
+  if (!ret) {
+    // restore state of SS in case of an error
+    digitalWrite(PN5180_NSS, HIGH);
+  }
+  recordCommand(opcode, startedCommand, ret);
   PN5180DEBUG_EXIT;
+  return ret;
+}
+
+/*
+ * Count one host interface command and its time in the statistics,
+ * a failed command was aborted by a BUSY timeout. Returns success.
+ */
+bool PN5180::recordCommand(uint8_t opcode, unsigned long startedUs, bool success) {
+  if (opcode < PN5180_STATS_OPCODES) {
+    stats.commandCount[opcode]++;
+    stats.commandTimeUs[opcode] += micros() - startedUs;
+    if (!success) stats.busyTimeouts[opcode]++;
+  }
+  return success;
+}
+
+/*
+ * Send SPI frame, steps 0..5 of the host interface command
+ */
+bool PN5180::sendFrame(const uint8_t *header, size_t headerLen, const uint8_t *payload, size_t payloadLen) {
+  // 0.
+  if (!waitForBusy(LOW)) {
+	  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/0)");
+	  return false;
+  }; // wait until busy is low
+  // 1.
+  digitalWrite(PN5180_NSS, LOW);
+  // 2.
+  spiWrite(header, headerLen);
+  if ((0 != payload) && (payloadLen > 0)) {
+    spiWrite(payload, payloadLen);
+  }
+  // 3.
+  if (!waitForBusy(HIGH)) {
+	  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/3)");
+	  return false;
+  }; // wait until busy is high
+  // 4.
+  digitalWrite(PN5180_NSS, HIGH);
+  // 5.
+  if (!waitForBusy(LOW)) {
+	  PN5180DEBUG("*** ERROR: transceiveCommand timeout (send/5)");
+	  return false;
+  }; // wait until busy is low
+  return true;
+}
+
+/*
+ * Burst transfers: the ESP32 SPIClass moves upto 64 bytes per FIFO load
+ * without gaps and does not overwrite the send buffer, other cores
+ * clock byte by byte. The spi_master DMA driver is not used, it needs
+ * exclusive ownership of the SPI host that SPIClass (and other devices
+ * on the bus, e.g. the ePaper) already use.
+ */
+void PN5180::spiWrite(const uint8_t *data, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+  PN5180_SPI.writeBytes(data, len);
+#else
+  for (size_t i=0; i<len; i++) {
+    PN5180_SPI.transfer(data[i]);
+  }
+#endif
+}
+
+void PN5180::spiRead(uint8_t *data, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+  PN5180_SPI.transferBytes(NULL, data, len);  // sends 0xFF
+#else
+  memset(data, 0xFF, len);
+  PN5180_SPI.transfer(data, len);
+#endif
+}
+
+/*
+ * Execute all register commands of the queue in one SPI transaction.
+ * The BUSY handshake is done between the frames, read results are stored
+ * in the locations given to PN5180CommandQueue::readRegister().
+ * The queue is cleared afterwards.
+ */
+bool PN5180::execute(PN5180CommandQueue &queue) {
+  PN5180DEBUG_PRINTF(F("PN5180::execute(queue, size=%d)"), queue.size());
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+
+  bool ret = true;
+  beginBus();
+  for (uint8_t i=0; i<queue.count; i++) {
+    PN5180CommandQueue::Op &op = queue.ops[i];
+    uint8_t *p = (uint8_t*)&op.value;
+    uint8_t cmd[] = { op.cmd, op.reg, p[0], p[1], p[2], p[3] };
+    if (PN5180_READ_REGISTER == op.cmd) {
+      ret = transceiveFrames(cmd, 2, (uint8_t*)op.result, 4);
+    }
+    else {
+      ret = transceiveFrames(cmd, sizeof(cmd));
+    }
+    if (!ret) {
+      PN5180DEBUG_PRINTF(F("*** ERROR: command %d of queue failed"), i);
+      PN5180DEBUG_PRINTLN();
+      break;
+    }
+  }
+  endBus();
+  if (!ret) {
+    digitalWrite(PN5180_NSS, HIGH);
+  }
+  queue.clear();
+
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
+bool PN5180CommandQueue::push(uint8_t cmd, uint8_t reg, uint32_t value, uint32_t *result) {
+  if (count >= PN5180_QUEUE_MAX_OPS) {
+    return false;
+  }
+  ops[count].cmd = cmd;
+  ops[count].reg = reg;
+  ops[count].value = value;
+  ops[count].result = result;
+  count++;
+  return true;
+}
+
+bool PN5180CommandQueue::writeRegister(uint8_t reg, uint32_t value) {
+  return push(PN5180_WRITE_REGISTER, reg, value, 0);
+}
+
+bool PN5180CommandQueue::writeRegisterWithOrMask(uint8_t reg, uint32_t mask) {
+  return push(PN5180_WRITE_REGISTER_OR_MASK, reg, mask, 0);
+}
+
+bool PN5180CommandQueue::writeRegisterWithAndMask(uint8_t reg, uint32_t mask) {
+  return push(PN5180_WRITE_REGISTER_AND_MASK, reg, mask, 0);
+}
+
+bool PN5180CommandQueue::readRegister(uint8_t reg, uint32_t *value) {
+  return push(PN5180_READ_REGISTER, reg, 0, value);
+}
+
+/*
+ * Wait until the BUSY line reaches the given level.
+ * The PN5180 toggles BUSY within a few microseconds for register and buffer
+ * access, so spin on the pin first. Long running commands (e.g. EEPROM writes,
+ * LOAD_RF_CONFIG) fall back to delay(1), which yields to other tasks.
+ * Returns false after commandTimeout ms.
+ */
+bool PN5180::waitForBusy(uint8_t level) {
+  unsigned long startedWaiting = micros();
+  while (level != digitalRead(PN5180_BUSY)) {
+    unsigned long waited = micros() - startedWaiting;
+    if (waited > busySpinTime) {
+      if (waited > (unsigned long)commandTimeout * 1000UL) {
+        invalidateRFState();  // PN5180 state is unknown now
+        return false;
+      }
+      delay(1);
+    }
+  }
+
+  uint32_t waited = micros() - startedWaiting;
+  stats.busyWaitCount++;
+  stats.busyWaitTotalUs += waited;
+  if (waited > stats.busyWaitMaxUs) {
+    stats.busyWaitMaxUs = waited;
+  }
+  uint8_t bucket = 0;
+  for (uint32_t limit = 4; (waited >= limit) && (bucket < PN5180_STATS_BUSY_BUCKETS-1); limit <<= 2) {
+    bucket++;
+  }
+  stats.busyWaitHistogram[bucket]++;
   return true;
 }
 
@@ -799,6 +1100,7 @@ bool PN5180::transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_
 void PN5180::reset() {
   PN5180DEBUG_PRINTLN(F("PN5180::reset()"));
   PN5180DEBUG_ENTER;
+  invalidateRFState();
   digitalWrite(PN5180_RST, LOW);  // at least 10us required
   delay(1);
   digitalWrite(PN5180_RST, HIGH); // 2ms to ramp up required
@@ -858,6 +1160,52 @@ bool PN5180::clearIRQStatus(uint32_t irqMask) {
   return ret;
 }
 
+/*
+ * Wait until one of the IRQs in irqMask is set, e.g. RX_IRQ_STAT at the end
+ * of an RF reception. IRQ_STATUS is polled over SPI, so the frame can be read
+ * as soon as it arrives. Polling yields with delay(1) after busySpinTime.
+ * Returns false on timeout or GENERAL_ERROR_IRQ_STAT, the last IRQ_STATUS
+ * value is stored in irqStatus if given.
+ * The IRQs in irqMask must be cleared before the command is sent.
+ */
+bool PN5180::waitForIRQ(uint32_t irqMask, uint32_t timeoutUs, uint32_t *irqStatus) {
+  PN5180DEBUG_PRINTF(F("PN5180::waitForIRQ(mask=%s"), formatHex(irqMask));
+  PN5180DEBUG_PRINTF(F(", timeout=%luus)"), (unsigned long)timeoutUs);
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_ENTER;
+  PN5180DEBUG_OFF;
+
+  bool ret = false;
+  uint32_t irq = 0;
+  unsigned long startedWaiting = micros();
+  while (true) {
+    irq = getIRQStatus();
+    if (irq & irqMask) {
+      ret = true;
+      break;
+    }
+    if (irq & GENERAL_ERROR_IRQ_STAT) {
+      break;
+    }
+    unsigned long waited = micros() - startedWaiting;
+    if (waited > timeoutUs) {
+      break;
+    }
+    if (waited > busySpinTime) {
+      delay(1);
+    }
+  }
+  if (irqStatus) *irqStatus = irq;
+
+  PN5180DEBUG_ON;
+  PN5180DEBUG(F("IRQ-Status=0x"));
+  PN5180DEBUG(formatHex(irq));
+  PN5180DEBUG(ret ? F(" ok") : F(" *** timeout/error"));
+  PN5180DEBUG_PRINTLN();
+  PN5180DEBUG_EXIT;
+  return ret;
+}
+
 /*
  * Get TRANSCEIVE_STATE from RF_STATUS register
  */
@@ -904,3 +1252,99 @@ PN5180TransceiveStat PN5180::getTransceiveState() {
   PN5180DEBUG_EXIT;
   return ret;
 }
+
+/*
+ * True if the given RF configuration is loaded and the RF field is on,
+ * i.e. loadRFConfig() and setRF_on() can be skipped.
+ * The cache is dropped by reset(), switchToLPCD() and any SPI timeout.
+ */
+bool PN5180::isRFReady(uint8_t txConf, uint8_t rxConf) {
+  return rfFieldOn && (rfTxConfig == txConf) && (rfRxConfig == rxConf);
+}
+
+void PN5180::invalidateRFState() {
+  rfTxConfig = 0xFF;
+  rfRxConfig = 0xFF;
+  rfFieldOn = false;
+  protocolPrepared = false;
+}
+
+/*
+ * Statistics, always compiled and cheap enough to leave enabled:
+ * a few micros() calls and counter increments per SPI command.
+ * Time totals are 32 bit and wrap after ~71 minutes, see resetStats().
+ */
+void PN5180::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void PN5180::recordPhase(PN5180Phase phase, unsigned long startedUs) {
+  uint32_t elapsed = micros() - startedUs;
+  PN5180PhaseStats &p = stats.phase[phase];
+  p.count++;
+  p.totalUs += elapsed;
+  if (elapsed > p.maxUs) {
+    p.maxUs = elapsed;
+  }
+}
+
+void PN5180::printStats(Print &out) {
+  static const char * const phaseNames[PN5180_PHASE_COUNT] = {
+    "REQA", "anticollision", "select", "activate", "presence", "inventory"
+  };
+
+  uint32_t busyTimeouts = 0;
+  out.println(F("PN5180 statistics:"));
+  for (uint8_t opcode=0; opcode<PN5180_STATS_OPCODES; opcode++) {
+    if (0 == stats.commandCount[opcode]) continue;
+    out.print(F("  cmd 0x"));
+    if (opcode < 0x10) out.print('0');
+    out.print(opcode, HEX);
+    out.print(F(": "));
+    out.print(stats.commandCount[opcode]);
+    out.print(F(" calls, avg "));
+    out.print(stats.commandTimeUs[opcode] / stats.commandCount[opcode]);
+    out.print(F(" us"));
+    if (stats.busyTimeouts[opcode] > 0) {
+      out.print(F(", "));
+      out.print(stats.busyTimeouts[opcode]);
+      out.print(F(" BUSY timeouts"));
+    }
+    out.println();
+    busyTimeouts += stats.busyTimeouts[opcode];
+  }
+  out.print(F("  BUSY: "));
+  out.print(stats.busyWaitCount);
+  out.print(F(" waits, avg "));
+  out.print(stats.busyWaitCount ? stats.busyWaitTotalUs / stats.busyWaitCount : 0);
+  out.print(F(" us, max "));
+  out.print(stats.busyWaitMaxUs);
+  out.print(F(" us, "));
+  out.print(busyTimeouts);
+  out.println(F(" timeouts"));
+  out.print(F("  BUSY histogram (<4us, <16us, ..., >=16ms):"));
+  for (uint8_t bucket=0; bucket<PN5180_STATS_BUSY_BUCKETS; bucket++) {
+    out.print(' ');
+    out.print(stats.busyWaitHistogram[bucket]);
+  }
+  out.println();
+  for (uint8_t phase=0; phase<PN5180_PHASE_COUNT; phase++) {
+    const PN5180PhaseStats &p = stats.phase[phase];
+    if (0 == p.count) continue;
+    out.print(F("  "));
+    out.print(phaseNames[phase]);
+    out.print(F(": "));
+    out.print(p.count);
+    out.print(F(" runs, avg "));
+    out.print(p.totalUs / p.count);
+    out.print(F(" us, max "));
+    out.print(p.maxUs);
+    out.println(F(" us"));
+  }
+  out.print(F("  recovery (WUPA, idle, RF cycle, reset):"));
+  for (uint8_t tier=0; tier<PN5180_RECOVERY_COUNT; tier++) {
+    out.print(' ');
+    out.print(stats.recoveryCount[tier]);
+  }
+  out.println();
+}
@@ -36,6 +36,7 @@
 #define TX_CONFIG           (0x18)
 #define CRC_TX_CONFIG       (0x19)
 #define RF_STATUS           (0x1d)
+#define AGC_VALUE           (0x1f)
 #define SYSTEM_STATUS       (0x24)
 #define TEMP_CONTROL        (0x25)
 #define AGC_REF_CONFIG      (0x26)
@@ -58,6 +59,17 @@
 #define LPCD_GPO_TOGGLE_BEFORE_FIELD_ON (0x39)  // 
 #define LPCD_GPO_TOGGLE_AFTER_FIELD_ON  (0x3A)  // 
 
+/*
+ * LPCD configuration, mirrors EEPROM LPCD_FIELD_ON_TIME..LPCD_GPO_TOGGLE_AFTER_FIELD_ON
+ */
+struct PN5180LPCDConfig {
+  uint8_t fieldOnTime = 0xF0;            // RF on time (μs) = 62 + (8 * fieldOnTime)
+  uint8_t threshold = 0x03;              // wake up if AGC > reference + threshold
+  uint8_t refValGpoControl = 0x01;       // 1 = self calibration, 0 = auto calibration
+  uint8_t gpoToggleBeforeFieldOn = 0xF0;
+  uint8_t gpoToggleAfterFieldOn = 0xF0;
+};
+
 enum PN5180TransceiveStat {
   PN5180_TS_Idle = 0,
   PN5180_TS_WaitTransmit = 1,
@@ -81,9 +93,97 @@ enum PN5180TransceiveStat {
 #define GENERAL_ERROR_IRQ_STAT 	(1<<17) // General error IRQ
 #define LPCD_IRQ_STAT 			(1<<19) // LPCD Detection IRQ
 
+// PN5180 RX_STATUS
+#define RX_BYTES_RECEIVED_MASK	(0x000001FF)
+#define RX_COLLISION_DETECTED 	(1UL<<18) // bit collision in the received frame
+#define RX_COLL_POS_SHIFT     	(19)      // bit position of the first collision, 7 bits
+#define RX_COLL_POS_MASK      	(0x7F)
+
+// PN5180 CRC_RX_CONFIG
+#define RX_BIT_ALIGN_SHIFT    	(6)       // first received bit is stored at this bit position of the first byte
+#define RX_BIT_ALIGN_MASK     	(0x000001C0)
+
 #define MIFARE_CLASSIC_KEYA 0x60  // Mifare Classic key A
 #define MIFARE_CLASSIC_KEYB 0x61  // Mifare Classic key B
 
+/*
+ * Always compiled command statistics, see PN5180::getStats()
+ */
+#define PN5180_STATS_OPCODES       (0x18)  // host interface commands 0x00..0x17
+#define PN5180_STATS_BUSY_BUCKETS  (8)     // BUSY wait bucket n counts waits < 4^(n+1) us, last one is open ended
+
+enum PN5180Phase {
+  PN5180_PHASE_REQA = 0,         // REQA/WUPA until ATQA (or no answer)
+  PN5180_PHASE_ANTICOLLISION,    // anti collision of one cascade level
+  PN5180_PHASE_SELECT,           // select of one cascade level until SAK
+  PN5180_PHASE_ACTIVATE,         // complete activateTypeA() with a card
+  PN5180_PHASE_PRESENCE,         // successful isCardPresent(uid, uidLength)
+  PN5180_PHASE_INVENTORY,        // complete getInventoryTypeA()
+  PN5180_PHASE_COUNT
+};
+
+enum PN5180Recovery {
+  PN5180_RECOVERY_WUPA = 0,      // retry the activation with WUPA, no reader state is touched
+  PN5180_RECOVERY_IDLE,          // Idle/StopCom and clear all IRQs
+  PN5180_RECOVERY_RF_CYCLE,      // RF field off, cards fall back to IDLE
+  PN5180_RECOVERY_RESET,         // hard reset via the RST pin
+  PN5180_RECOVERY_COUNT
+};
+
+struct PN5180PhaseStats {
+  uint32_t count;
+  uint32_t totalUs;
+  uint32_t maxUs;
+};
+
+struct PN5180Stats {
+  uint32_t commandCount[PN5180_STATS_OPCODES];    // calls per opcode
+  uint32_t commandTimeUs[PN5180_STATS_OPCODES];   // SPI frames incl. BUSY handshake per opcode, timed out ones too
+  uint32_t busyTimeouts[PN5180_STATS_OPCODES];    // commands aborted by a BUSY timeout per opcode
+  uint32_t busyWaitCount;
+  uint32_t busyWaitTotalUs;
+  uint32_t busyWaitMaxUs;
+  uint32_t busyWaitHistogram[PN5180_STATS_BUSY_BUCKETS];
+  PN5180PhaseStats phase[PN5180_PHASE_COUNT];
+  uint32_t recoveryCount[PN5180_RECOVERY_COUNT];  // recover() calls per tier
+};
+
+/*
+ * Queue of register commands, sent by PN5180::execute() in one SPI transaction
+ */
+#define PN5180_QUEUE_MAX_OPS (8)
+
+class PN5180CommandQueue {
+  friend class PN5180;
+public:
+  /* cmd 0x00 */
+  bool writeRegister(uint8_t reg, uint32_t value);
+  /* cmd 0x01 */
+  bool writeRegisterWithOrMask(uint8_t reg, uint32_t mask);
+  /* cmd 0x02 */
+  bool writeRegisterWithAndMask(uint8_t reg, uint32_t mask);
+  /* cmd 0x04, value is stored by PN5180::execute() */
+  bool readRegister(uint8_t reg, uint32_t *value);
+
+  uint8_t size() const { return count; }
+  void clear() { count = 0; }
+
+private:
+  struct Op {
+    uint8_t cmd;
+    uint8_t reg;
+    uint32_t value;
+    uint32_t *result;
+  };
+  Op ops[PN5180_QUEUE_MAX_OPS];
+  uint8_t count = 0;
+
+  bool push(uint8_t cmd, uint8_t reg, uint32_t value, uint32_t *result);
+};
+
+// SPI bus arbitration hook, see PN5180::setBusLock()
+typedef void (*PN5180BusLockFn)(void *context);
+
 class PN5180 {
 private:
   uint8_t PN5180_NSS;   // active low
@@ -95,8 +195,21 @@ private:
   int8_t PN5180_MOSI;
 
   SPISettings SPI_SETTINGS;
-  static uint8_t readBufferStatic16[16];
+  uint8_t readBuffer16[16];      // per instance, several readers may run in different tasks
   uint8_t* readBufferDynamic508 = NULL;
+  PN5180LPCDConfig lpcdConfig;
+  bool lpcdConfigValid = false;  // lpcdConfig matches EEPROM content
+  // cached RF state, see isRFReady()
+  uint8_t rfTxConfig = 0xFF;     // last loaded transmitter configuration, 0xFF = unknown
+  uint8_t rfRxConfig = 0xFF;     // last loaded receiver configuration, 0xFF = unknown
+  bool rfFieldOn = false;
+  PN5180Stats stats;
+  PN5180BusLockFn busLock = 0;
+  PN5180BusLockFn busUnlock = 0;
+  void *busLockContext = 0;
+protected:
+  // protocol registers (crypto, CRC) are in the idle setup of the protocol class
+  bool protocolPrepared = false;
 public:
   PN5180(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi=SPI);
   ~PN5180();
@@ -104,6 +217,7 @@ public:
   void begin(int8_t sck=-1, int8_t miso=-1, int8_t mosi=-1, int8_t SSpin=-1);
   void end();
   void setSPISettingsFrecuency(uint32_t frecuency);
+  void setBusLock(PN5180BusLockFn lock, PN5180BusLockFn unlock, void *context = 0);
 
   /*
    * PN5180 direct commands with host interface
@@ -129,8 +243,11 @@ public:
   /* cmd 0x0a */
   uint8_t * readData(int len);
   bool readData(int len, uint8_t *buffer);
+  bool readData(uint8_t *header, int headerLen, uint8_t *buffer, int len);
   /* prepare LPCD registers */
   bool prepareLPCD();
+  bool prepareLPCD(const PN5180LPCDConfig &config);
+  bool calibrateLPCD(PN5180LPCDConfig &config, uint8_t samples = 16, uint8_t margin = 2);
   /* cmd 0x0B */
   bool switchToLPCD(uint16_t wakeupCounterInMs);
   /* cmd 0x0C */
@@ -145,23 +262,51 @@ public:
 
   bool sendCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer, size_t recvBufferLen);
 
+  /* register commands, batched in one SPI transaction */
+  bool execute(PN5180CommandQueue &queue);
+
   /*
    * Helper functions
    */
 public:
   void reset();
+  bool recover(PN5180Recovery tier);
 
   uint16_t commandTimeout = 500;
+  uint16_t busySpinTime = 1000;  // us to spin on BUSY before sleeping with delay(1)
   uint32_t getIRQStatus();
   bool clearIRQStatus(uint32_t irqMask);
+  bool waitForIRQ(uint32_t irqMask, uint32_t timeoutUs, uint32_t *irqStatus = 0);
 
   PN5180TransceiveStat getTransceiveState();
 
+  bool isRFReady(uint8_t txConf, uint8_t rxConf);
+  void invalidateRFState();
+
+  /* statistics, always compiled (unlike PN5180DEBUG) */
+  const PN5180Stats &getStats() const { return stats; }
+  void resetStats();
+  void printStats(Print &out = Serial);
+
+protected:
+  void recordPhase(PN5180Phase phase, unsigned long startedUs);
+
   /*
    * Private methods, called within an SPI transaction
    */
 private:
-  bool transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer = 0, size_t recvBufferLen = 0);
+  bool transceiveCommand(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer = 0, size_t recvBufferLen = 0,
+                         uint8_t *recvBuffer2 = 0, size_t recvBuffer2Len = 0);
+  bool transceiveFrames(uint8_t *sendBuffer, size_t sendBufferLen, uint8_t *recvBuffer = 0, size_t recvBufferLen = 0,
+                        uint8_t *recvBuffer2 = 0, size_t recvBuffer2Len = 0);
+  bool transceivePayload(const uint8_t *header, size_t headerLen, const uint8_t *payload, size_t payloadLen);
+  bool sendFrame(const uint8_t *header, size_t headerLen, const uint8_t *payload, size_t payloadLen);
+  void spiWrite(const uint8_t *data, size_t len);
+  void spiRead(uint8_t *data, size_t len);
+  bool waitForBusy(uint8_t level);
+  bool recordCommand(uint8_t opcode, unsigned long startedUs, bool success);
+  void beginBus();
+  void endBus();
 
 };
 
@@ -0,0 +1,98 @@
+// NAME: PN5180CardType.cpp
+//
+// DESC: ISO14443A UID/SAK validation and card type classification.
+//
+// This file is part of the PN5180 library for the Arduino environment.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+#include "PN5180CardType.h"
+
+// SAK 0x00, 0x08, 0x09, 0x10, 0x11, 0x18, 0x20, 0x28, 0x88, 0x89
+const uint32_t PN5180_VALID_SAK[8] = {
+  0x01030301, 0x00000101, 0x00000000, 0x00000000,
+  0x00000300, 0x00000000, 0x00000000, 0x00000000
+};
+
+/*
+ * Check an UID of 4, 7 or 10 bytes (cascade tags removed) in one pass:
+ * - the first byte (manufacturer) is not 0x00, unknown manufacturer 0xFF is allowed
+ * - the first byte of the last cascade level is not the cascade tag 0x88
+ * - the bytes after the first one are not only 0x00/0xFF (e.g. 0x04 0x00 0xFF 0x00)
+ * - the last three bytes are neither all 0x00 nor all 0xFF
+ */
+bool PN5180IsValidUID(const uint8_t *uid, uint8_t uidLength) {
+  if ((uidLength != 4) && (uidLength != 7) && (uidLength != 10)) {
+    return false;
+  }
+  if ((uid[0] == 0x00) || (uid[uidLength - 4] == 0x88)) {
+    return false;
+  }
+  // any byte besides 0x00/0xFF, OR/AND of the last three bytes
+  bool mixed = false;
+  uint8_t tailOr = 0x00;
+  uint8_t tailAnd = 0xFF;
+  for (uint8_t i = 1; i < uidLength; i++) {
+    uint8_t b = uid[i];
+    mixed |= (b != 0x00) && (b != 0xFF);
+    if (i >= uidLength - 3) {
+      tailOr |= b;
+      tailAnd &= b;
+    }
+  }
+  return mixed && (tailOr != 0x00) && (tailAnd != 0xFF);
+}
+
+/*
+ * Card family from ATQA and SAK, see NXP AN10833. No RF traffic, so a
+ * SAK 0x20 card is only told apart by its ATQA.
+ */
+PN5180CardType PN5180GetCardType(uint16_t atqa, uint8_t sak) {
+  switch (sak) {
+    case 0x00:
+      return PN5180_CARD_ULTRALIGHT;
+    case 0x09:
+      return PN5180_CARD_CLASSIC_MINI;
+    case 0x08:
+    case 0x88:
+    case 0x28:
+      return PN5180_CARD_CLASSIC_1K;
+    case 0x18:
+      return PN5180_CARD_CLASSIC_4K;
+    case 0x10:
+    case 0x11:
+      return PN5180_CARD_PLUS;
+    case 0x20:
+      if (atqa == 0x0344) {
+        return PN5180_CARD_DESFIRE;
+      }
+      // Plus SL3 answers with the ATQA of a Classic 2K/4K card
+      if ((atqa == 0x0002) || (atqa == 0x0004) || (atqa == 0x0042) || (atqa == 0x0044)) {
+        return PN5180_CARD_PLUS;
+      }
+      return PN5180_CARD_ISO14443_4;
+    default:
+      return PN5180_CARD_UNKNOWN;
+  }
+}
+
+const char *PN5180CardTypeName(PN5180CardType type) {
+  switch (type) {
+    case PN5180_CARD_ULTRALIGHT:   return "Ultralight/NTAG";
+    case PN5180_CARD_CLASSIC_MINI: return "Classic Mini";
+    case PN5180_CARD_CLASSIC_1K:   return "Classic 1K";
+    case PN5180_CARD_CLASSIC_4K:   return "Classic 4K";
+    case PN5180_CARD_PLUS:         return "Plus";
+    case PN5180_CARD_DESFIRE:      return "DESFire";
+    case PN5180_CARD_ISO14443_4:   return "ISO14443-4";
+    default:                       return "unknown";
+  }
+}
@@ -0,0 +1,61 @@
+// NAME: PN5180CardType.h
+//
+// DESC: ISO14443A UID/SAK validation and card type classification.
+//
+// This file is part of the PN5180 library for the Arduino environment.
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+#ifndef PN5180CARDTYPE_H
+#define PN5180CARDTYPE_H
+
+#include <stdint.h>
+
+/*
+ * Card families, as far as ATQA and SAK of the activation tell them apart
+ */
+enum PN5180CardType {
+  PN5180_CARD_UNKNOWN = 0,
+  PN5180_CARD_ULTRALIGHT,        // SAK 0x00: MIFARE Ultralight, NTAG
+  PN5180_CARD_CLASSIC_MINI,      // SAK 0x09
+  PN5180_CARD_CLASSIC_1K,        // SAK 0x08, 0x88 (Infineon), 0x28 (SmartMX emulation)
+  PN5180_CARD_CLASSIC_4K,        // SAK 0x18
+  PN5180_CARD_PLUS,              // SAK 0x10/0x11 (SL2), SAK 0x20 with Plus ATQA (SL3)
+  PN5180_CARD_DESFIRE,           // SAK 0x20 with ATQA 0x0344
+  PN5180_CARD_ISO14443_4,        // other SAK 0x20 cards
+  PN5180_CARD_TYPE_COUNT
+};
+
+/*
+ * SAK values accepted by PN5180IsValidSAK(), one bit per SAK
+ */
+extern const uint32_t PN5180_VALID_SAK[8];
+
+/*
+ * True for the SAK of a known MIFARE/ISO14443-4 card
+ */
+inline bool PN5180IsValidSAK(uint8_t sak) {
+  return (PN5180_VALID_SAK[sak >> 5] >> (sak & 0x1F)) & 1;
+}
+
+/*
+ * True for an ATQA that a card can send (not 0x0000 or 0xFFFF), the ATQA is
+ * buffer[0] | buffer[1] << 8 of the activateTypeA() result.
+ */
+inline bool PN5180IsValidATQA(uint16_t atqa) {
+  return (atqa != 0x0000) && (atqa != 0xFFFF);
+}
+
+bool PN5180IsValidUID(const uint8_t *uid, uint8_t uidLength);
+PN5180CardType PN5180GetCardType(uint16_t atqa, uint8_t sak);
+const char *PN5180CardTypeName(PN5180CardType type);
+
+#endif /* PN5180CARDTYPE_H */
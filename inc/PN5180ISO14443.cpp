@@ -23,6 +23,15 @@
 #include <PN5180.h>
 #include "Debug.h"
 
+// max. time to wait for a card response (frame delay time is ~100us)
+#ifndef ISO14443_RX_TIMEOUT_US
+#define ISO14443_RX_TIMEOUT_US    (5000)
+#endif
+// max. time to wait for the ACK of a Mifare write
+#ifndef ISO14443_WRITE_TIMEOUT_US
+#define ISO14443_WRITE_TIMEOUT_US (10000)
+#endif
+
 PN5180ISO14443::PN5180ISO14443(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi) 
               : PN5180(SSpin, BUSYpin, RSTpin, spi) {
 }
@@ -52,6 +61,58 @@ bool PN5180ISO14443::setupRF() {
 }
 
 
+/*
+ * Switch RX and TX CRC calculation on/off in one SPI transaction
+ */
+bool PN5180ISO14443::enableCRC(bool on) {
+	PN5180CommandQueue queue;
+	if (on) {
+		queue.writeRegisterWithOrMask(CRC_RX_CONFIG, 0x01);
+		queue.writeRegisterWithOrMask(CRC_TX_CONFIG, 0x01);
+	}
+	else {
+		queue.writeRegisterWithAndMask(CRC_RX_CONFIG, 0xFFFFFFFE);
+		queue.writeRegisterWithAndMask(CRC_TX_CONFIG, 0xFFFFFFFE);
+	}
+	return execute(queue);
+}
+
+/*
+ * Load standard TypeA protocol, switch on the RF field and
+ * restore the idle setup (crypto and CRC off) of the protocol
+ */
+bool PN5180ISO14443::prepareTypeA() {
+	// a new activation ends any Mifare authentication
+	mifareAuthSector = 0xFF;
+	// Load standard TypeA protocol and switch on the RF field,
+	// skipped if still active from the previous poll
+	if (!isRFReady(0x00, 0x80)) {
+		if (!loadRFConfig(0x0, 0x80)) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: Load standard TypeA protocol failed!"));
+			return false;
+		}
+
+		// activate RF field
+		setRF_on();
+		// wait RF-field to ramp-up
+		delay(10);
+	}
+	
+	// Crypto and CRC are left untouched by an empty poll
+	if (!protocolPrepared) {
+		PN5180CommandQueue queue;
+		queue.writeRegisterWithAndMask(SYSTEM_CONFIG, 0xFFFFFFBF);  // OFF Crypto
+		queue.writeRegisterWithAndMask(CRC_RX_CONFIG, ~(RX_BIT_ALIGN_MASK | 0x01));  // clear RX CRC and bit alignment
+		queue.writeRegisterWithAndMask(CRC_TX_CONFIG, 0xFFFFFFFE);  // clear TX CRC
+		if (!execute(queue)) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: OFF Crypto / clear CRC failed!"));
+			return false;
+		}
+		protocolPrepared = true;
+	}
+	return true;
+}
+
 uint16_t PN5180ISO14443::rxBytesReceived() {
 	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::rxBytesReceived()"));	
 	PN5180DEBUG_ENTER;
@@ -79,8 +140,9 @@ uint16_t PN5180ISO14443::rxBytesReceived() {
 *
 * return value: the uid length:
 * -	zero if no tag was recognized
-* - -1 general error
-* - -2 card in field but with error
+* - -1 general error, the reader failed (SPI, BUSY timeout)
+* - -2 card in field but with error: answered REQA/WUPA, but not the
+*      anti collision or select (e.g. at the edge of the field)
 * -	single Size UID (4 byte)
 * -	double Size UID (7 byte)
 * -	triple Size UID (10 byte) - not yet supported
@@ -88,63 +150,18 @@ uint16_t PN5180ISO14443::rxBytesReceived() {
 int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
 	uint8_t cmd[7];
 	uint8_t uidLength = 0;
+	unsigned long startedActivate = micros();
 	
 	PN5180DEBUG_PRINTF(F("PN5180ISO14443::activateTypeA(*buffer, kind=%d)"), kind);
 	PN5180DEBUG_PRINTLN();
 	PN5180DEBUG_ENTER;
 
-	// Load standard TypeA protocol already done in reset()
-	if (!loadRFConfig(0x0, 0x80)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: Load standard TypeA protocol failed!"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
-
-	// activate RF field
-	setRF_on();
-	// wait RF-field to ramp-up
-	delay(10);
-	
-	// OFF Crypto
-	if (!writeRegisterWithAndMask(SYSTEM_CONFIG, 0xFFFFFFBF)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: OFF Crypto failed!"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
-	// clear RX CRC
-	if (!writeRegisterWithAndMask(CRC_RX_CONFIG, 0xFFFFFFFE)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: Clear RX CRC failed!"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
-	// clear TX CRC
-	if (!writeRegisterWithAndMask(CRC_TX_CONFIG, 0xFFFFFFFE)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: Clear TX CRC failed!"));
+	if (!prepareTypeA()) {
 		PN5180DEBUG_EXIT;
 		return -1;
 	}
 
-	// set the PN5180 into IDLE state  
-	if (!writeRegisterWithAndMask(SYSTEM_CONFIG, 0xFFFFFFF8)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: set IDLE state failed!"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
-		
-	// activate TRANSCEIVE routine  
-	if (!writeRegisterWithOrMask(SYSTEM_CONFIG, 0x00000003)) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: Activates TRANSCEIVE routine failed!"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
-	
-	// wait for wait-transmit state
-	PN5180TransceiveStat transceiveState = getTransceiveState();
-	if (PN5180_TS_WaitTransmit != transceiveState) {
-		PN5180DEBUG_PRINTLN(F("*** ERROR: Transceiver not in state WaitTransmit!?"));
-		PN5180DEBUG_EXIT;
-		return -1;
-	}
+	// IDLE state, TRANSCEIVE routine and the wait-transmit check are done by sendData()
 	
 /*	uint8_t irqConfig = 0b0000000; // Set IRQ active low + clear IRQ-register
     writeEEprom(IRQ_PIN_CONFIG, &irqConfig, 1);
@@ -153,25 +170,32 @@ int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
 */
 
 	// clear all IRQs
+	unsigned long startedPhase = micros();
 	clearIRQStatus(0xffffffff); 
 
 	//Send REQA/WUPA, 7 bits in last byte
 	cmd[0] = (kind == 0) ? 0x26 : 0x52;
 	if (!sendData(cmd, 1, 0x07)) {
 		PN5180DEBUG_PRINTLN(F("*** ERROR: Send REQA/WUPA failed!"));
+		protocolPrepared = false;
 		PN5180DEBUG_EXIT;
-		return 0;
+		return -1;
 	}
 	
-	// wait some mSecs for end of RF receiption
-	delay(10);
+	// wait for end of RF reception, no answer means no card
+	if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+		recordPhase(PN5180_PHASE_REQA, startedPhase);
+		PN5180DEBUG_EXIT;
+		return 0;
+	}
 
 	// READ 2 bytes ATQA into  buffer
 	if (!readData(2, buffer)) {
 		PN5180DEBUG(F("*** ERROR: READ 2 bytes ATQA failed!\n"));
 		PN5180DEBUG_EXIT;
-		return 0;
+		return -1;
 	}
+	recordPhase(PN5180_PHASE_REQA, startedPhase);
 	
 	// 
 	unsigned long startedWaiting = millis();
@@ -189,6 +213,7 @@ int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
     PN5180DEBUG_ON;
 	
 	// clear all IRQs
+	startedPhase = micros();
 	clearIRQStatus(0xffffffff); 
 	
 	// send Anti collision 1, 8 bits in last byte
@@ -197,11 +222,15 @@ int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
 	if (!sendData(cmd, 2, 0x00)) {
 		PN5180DEBUG_PRINTLN(F("*** ERROR: Send Anti collision 1 failed!"));
 		PN5180DEBUG_EXIT;
-		return -2;
+		return -1;
 	}
 	
-	// wait some mSecs for end of RF receiption
-	delay(5);
+	// wait for end of RF reception
+	if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+		PN5180DEBUG_PRINTLN(F("*** ERROR: No answer to Anti collision 1!"));
+		PN5180DEBUG_EXIT;
+		return -2;
+	}
 
 	uint8_t numBytes = rxBytesReceived();
 	if (numBytes != 5) {
@@ -213,36 +242,40 @@ int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
 	if (!readData(5, cmd+2)) {
 		Serial.println("Read 5 bytes failed!");
 		PN5180DEBUG_EXIT;
-		return -2;
+		return -1;
 	}
+	recordPhase(PN5180_PHASE_ANTICOLLISION, startedPhase);
 	// We do have a card now! enable CRC and send anticollision
 	// save the first 4 bytes of UID
 	for (int i = 0; i < 4; i++) buffer[i] = cmd[2 + i];
 	
-	//Enable RX CRC calculation
-	if (!writeRegisterWithOrMask(CRC_RX_CONFIG, 0x01)) {
-		PN5180DEBUG_EXIT;
-		return -2;
-	}
-	//Enable TX CRC calculation
-	if (!writeRegisterWithOrMask(CRC_TX_CONFIG, 0x01)) {
+	// CRC is switched on now, next poll has to restore the idle setup
+	protocolPrepared = false;
+	//Enable RX and TX CRC calculation
+	if (!enableCRC(true)) {
 		PN5180DEBUG_EXIT;
-		return -2;
+		return -1;
 	}
 
 	//Send Select anti collision 1, the remaining bytes are already in offset 2 onwards
+	startedPhase = micros();
+	clearIRQStatus(0xffffffff);
 	cmd[0] = 0x93;
 	cmd[1] = 0x70;
 	if (!sendData(cmd, 7, 0x00)) {
-		// no remaining bytes, we have a 4 byte UID
 		PN5180DEBUG_EXIT;
-		return 4;
+		return -1;
+	}
+	if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+		PN5180DEBUG_EXIT;
+		return -2;
 	}
 	//Read 1 byte SAK into buffer[2]
 	if (!readData(1, buffer+2)) {
 		PN5180DEBUG_EXIT;
-		return -2;
+		return -1;
 	}
+	recordPhase(PN5180_PHASE_SELECT, startedPhase);
 	// Check if the tag is 4 Byte UID or 7 byte UID and requires anti collision 2
 	// If Bit 3 is 0 it is 4 Byte UID
 	if ((buffer[2] & 0x04) == 0) {
@@ -257,113 +290,673 @@ int8_t PN5180ISO14443::activateTypeA(uint8_t *buffer, uint8_t kind) {
 			return 0;
 		}
 		for (int i = 0; i < 3; i++) buffer[3+i] = cmd[3 + i];
-		// Clear RX CRC
-		if (!writeRegisterWithAndMask(CRC_RX_CONFIG, 0xFFFFFFFE)) {
-			PN5180DEBUG_EXIT;
-			return -2;
-		}
-		// Clear TX CRC
-		if (!writeRegisterWithAndMask(CRC_TX_CONFIG, 0xFFFFFFFE)) {
+		// Clear RX and TX CRC
+		if (!enableCRC(false)) {
 			PN5180DEBUG_EXIT;
-			return -2;
+			return -1;
 		}
 		// Do anti collision 2
+		startedPhase = micros();
+		clearIRQStatus(0xffffffff);
 		cmd[0] = 0x95;
 		cmd[1] = 0x20;
 		if (!sendData(cmd, 2, 0x00)) {
+			PN5180DEBUG_EXIT;
+			return -1;
+		}
+		if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
 			PN5180DEBUG_EXIT;
 			return -2;
 		}
 		//Read 5 bytes. we will store at offset 2 for later use
 		if (!readData(5, cmd+2)) {
 			PN5180DEBUG_EXIT;
-			return -2;
+			return -1;
 		}
+		recordPhase(PN5180_PHASE_ANTICOLLISION, startedPhase);
 		// first 4 bytes belongs to last 4 UID bytes, we keep it.
 		for (int i = 0; i < 4; i++) {
 		  buffer[6 + i] = cmd[2+i];
 		}
-		//Enable RX CRC calculation
-		if (!writeRegisterWithOrMask(CRC_RX_CONFIG, 0x01)) {
+		//Enable RX and TX CRC calculation
+		if (!enableCRC(true)) {
 			PN5180DEBUG_EXIT;
-			return -2;
-		}
-		//Enable TX CRC calculation
-		if (!writeRegisterWithOrMask(CRC_TX_CONFIG, 0x01)) {
-			PN5180DEBUG_EXIT;
-			return -2;
+			return -1;
 		}
 		//Send Select anti collision 2 
+		startedPhase = micros();
+		clearIRQStatus(0xffffffff);
 		cmd[0] = 0x95;
 		cmd[1] = 0x70;
 		if (!sendData(cmd, 7, 0x00)) {
+			PN5180DEBUG_EXIT;
+			return -1;
+		}
+		if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
 			PN5180DEBUG_EXIT;
 			return -2;
 		}
 		//Read 1 byte SAK into buffer[2]
 		if (!readData(1, buffer + 2)) {
 			PN5180DEBUG_EXIT;
-			return -2;
+			return -1;
 		}
+		recordPhase(PN5180_PHASE_SELECT, startedPhase);
 		uidLength = 7;
 	}
+	recordPhase(PN5180_PHASE_ACTIVATE, startedActivate);
 	PN5180DEBUG_EXIT;
     return uidLength;
 }
 
-bool PN5180ISO14443::mifareBlockRead(uint8_t blockno, uint8_t *buffer) {
+/*
+ * Anti collision of one cascade level with bit oriented frames:
+ * on a collision the UID bit is set to 1, the known bits are sent
+ * again and the next card answers with the remaining bits.
+ * uidPart : must be 5 byte array, receives the 4 UID bytes (or CT + 3 bytes) and BCC
+ *
+ * The collision position of RX_STATUS counts from bit 0 of the first
+ * received byte, i.e. includes the RX_BIT_ALIGN bits.
+ */
+bool PN5180ISO14443::anticollisionLevel(uint8_t level, uint8_t *uidPart) {
+	static const uint8_t selectCmd[3] = { 0x93, 0x95, 0x97 };
+	uint8_t cmd[7];
+	uint8_t rx[5];
+	uint8_t knownBits = 0;
 	bool success = false;
-	uint16_t len;
+
+	for (int i = 0; i < 5; i++) uidPart[i] = 0;
+
+	// every round resolves at least one more UID bit
+	for (uint8_t round = 0; round <= 32; round++) {
+		uint8_t fullBytes = knownBits / 8;
+		uint8_t lastBits = knownBits % 8;
+		uint8_t sendBytes = fullBytes + ((lastBits > 0) ? 1 : 0);
+
+		// NVB: upper nibble byte count incl. SEL/NVB, lower nibble extra bits
+		cmd[0] = selectCmd[level];
+		cmd[1] = (uint8_t)(((2 + fullBytes) << 4) | lastBits);
+		for (int i = 0; i < sendBytes; i++) cmd[2 + i] = uidPart[i];
+
+		// the card answers with the remaining bits of the partially sent byte
+		PN5180CommandQueue queue;
+		queue.writeRegisterWithAndMask(CRC_RX_CONFIG, ~RX_BIT_ALIGN_MASK);
+		queue.writeRegisterWithOrMask(CRC_RX_CONFIG, (uint32_t)lastBits << RX_BIT_ALIGN_SHIFT);
+		if (!execute(queue)) break;
+
+		clearIRQStatus(0xffffffff);
+		if (!sendData(cmd, 2 + sendBytes, lastBits)) break;
+		if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: No answer to Anti collision!"));
+			break;
+		}
+
+		uint32_t rxStatus;
+		if (!readRegister(RX_STATUS, &rxStatus)) break;
+		uint16_t numBytes = (uint16_t)(rxStatus & RX_BYTES_RECEIVED_MASK);
+		if ((numBytes == 0) || (fullBytes + numBytes > 5) || !readData(numBytes, rx)) break;
+
+		// merge, the first byte keeps the bits we have sent
+		uint8_t sentMask = (uint8_t)((1 << lastBits) - 1);
+		uidPart[fullBytes] = (uidPart[fullBytes] & sentMask) | (rx[0] & ~sentMask);
+		for (int i = 1; i < numBytes; i++) uidPart[fullBytes + i] = rx[i];
+
+		if ((rxStatus & RX_COLLISION_DETECTED) == 0) {
+			success = (fullBytes + numBytes == 5) &&
+			          (uidPart[4] == (uidPart[0] ^ uidPart[1] ^ uidPart[2] ^ uidPart[3]));
+			break;
+		}
+
+		uint8_t collisionBit = fullBytes * 8 + ((rxStatus >> RX_COLL_POS_SHIFT) & RX_COLL_POS_MASK);
+		// sent bits can not collide, BCC collides only with equal UID bits
+		if ((collisionBit < knownBits) || (collisionBit >= 32)) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: Invalid collision position!"));
+			break;
+		}
+		PN5180DEBUG_PRINTF(F("Collision at bit %d"), collisionBit);
+		PN5180DEBUG_PRINTLN();
+
+		// take the 1 branch, bits above the collision are unknown
+		uint8_t bit = collisionBit % 8;
+		uidPart[collisionBit / 8] = (uidPart[collisionBit / 8] & (uint8_t)((1 << bit) - 1)) | (uint8_t)(1 << bit);
+		knownBits = collisionBit + 1;
+	}
+
+	writeRegisterWithAndMask(CRC_RX_CONFIG, ~RX_BIT_ALIGN_MASK);
+	return success;
+}
+
+/*
+* Find all ISO14443A cards in the field: the collisions are resolved
+* bit by bit, each card is selected and put into HALT state, so the
+* next REQA is answered by the remaining cards only.
+* uid       : must be 10 * maxCards byte array, 10 bytes per card
+* uidLength : must be maxCards byte array, 4, 7 or 10 per card
+*
+* return value:
+* - number of cards found
+* - -1 general error
+*/
+int8_t PN5180ISO14443::getInventoryTypeA(uint8_t *uid, uint8_t *uidLength, uint8_t maxCards) {
+	PN5180DEBUG_PRINTF(F("PN5180ISO14443::getInventoryTypeA(*uid, *uidLength, maxCards=%d)"), maxCards);
+	PN5180DEBUG_PRINTLN();
+	PN5180DEBUG_ENTER;
+
+	static const uint8_t selectCmd[3] = { 0x93, 0x95, 0x97 };
+	unsigned long startedInventory = micros();
+	uint8_t numCards = 0;
+	uint8_t cmd[7];
+
+	while (numCards < maxCards) {
+		if (!prepareTypeA()) {
+			PN5180DEBUG_EXIT;
+			return -1;
+		}
+
+		// REQA, 7 bits in last byte, halted cards do not answer
+		unsigned long startedPhase = micros();
+		clearIRQStatus(0xffffffff);
+		cmd[0] = 0x26;
+		if (!sendData(cmd, 1, 0x07)) {
+			protocolPrepared = false;
+			PN5180DEBUG_EXIT;
+			return -1;
+		}
+		if (!waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+			recordPhase(PN5180_PHASE_REQA, startedPhase);
+			break;  // no more cards
+		}
+		// the ATQA of several cards may collide, it is not used here
+		readData(2, cmd);
+		recordPhase(PN5180_PHASE_REQA, startedPhase);
+
+		uint8_t *cardUid = uid + 10 * numCards;
+		uint8_t length = 0;
+		bool selected = false;
+		for (uint8_t level = 0; level < 3; level++) {
+			startedPhase = micros();
+			if (!anticollisionLevel(level, cmd + 2)) break;
+			recordPhase(PN5180_PHASE_ANTICOLLISION, startedPhase);
+
+			// CRC is switched on now, next poll has to restore the idle setup
+			protocolPrepared = false;
+			if (!enableCRC(true)) break;
+			startedPhase = micros();
+			clearIRQStatus(0xffffffff);
+			cmd[0] = selectCmd[level];
+			cmd[1] = 0x70;
+			if (!sendData(cmd, 7, 0x00) || !waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) break;
+			uint8_t sak;
+			if ((rxBytesReceived() != 1) || !readData(1, &sak)) break;
+			recordPhase(PN5180_PHASE_SELECT, startedPhase);
+
+			if ((sak & 0x04) == 0) {
+				for (int i = 0; i < 4; i++) cardUid[length++] = cmd[2 + i];
+				selected = true;
+				break;
+			}
+			// cascade tag 88 is no part of the UID
+			if ((cmd[2] != 0x88) || !enableCRC(false)) break;
+			for (int i = 0; i < 3; i++) cardUid[length++] = cmd[3 + i];
+		}
+		if (!selected) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: Card lost in anti collision/select!"));
+			break;
+		}
+		uidLength[numCards++] = length;
+
+		// HLTA with CRC, the card does not answer
+		protocolPrepared = false;
+		if (!enableCRC(true)) break;
+		clearIRQStatus(0xffffffff);
+		cmd[0] = 0x50;
+		cmd[1] = 0x00;
+		if (!sendData(cmd, 2, 0x00) || !waitForIRQ(TX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) break;
+	}
+
+	recordPhase(PN5180_PHASE_INVENTORY, startedInventory);
+	PN5180DEBUG_EXIT;
+	return numCards;
+}
+
+/*
+ * Non-blocking activateTypeA(): sends REQA/WUPA and returns, the following
+ * frames are sent by poll() as soon as the card has answered. The RF wait
+ * times are left to the caller, e.g. for other work or vTaskDelay().
+ * buffer   : must be 10 byte array, same layout as activateTypeA()
+ * callback : (optional) called once with the result of activateTypeA()
+ *
+ * returns false if a transaction is still running or the activation has
+ * already failed, the callback is called with -1 in the latter case
+ */
+bool PN5180ISO14443::startActivateTypeA(uint8_t *buffer, uint8_t kind, PN5180ActivateCallback callback, void *context) {
+	PN5180DEBUG_PRINTF(F("PN5180ISO14443::startActivateTypeA(*buffer, kind=%d)"), kind);
+	PN5180DEBUG_PRINTLN();
+	PN5180DEBUG_ENTER;
+
+	if (isBusy()) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+	asyncBuffer = buffer;
+	asyncKind = kind;
+	asyncLevel = 0;
+	asyncCallback = callback;
+	asyncContext = context;
+	asyncStartedActivate = micros();
+	asyncStartedUs = asyncStartedActivate;
+
+	if (!isRFReady(0x00, 0x80)) {
+		if (!loadRFConfig(0x0, 0x80) || !setRF_on()) {
+			PN5180DEBUG_PRINTLN(F("*** ERROR: Load standard TypeA protocol failed!"));
+			finishActivate(-1);
+			PN5180DEBUG_EXIT;
+			return false;
+		}
+		// RF-field ramp-up is awaited by poll()
+		asyncStep = PN5180_ACTIVATE_RF_RAMP;
+		PN5180DEBUG_EXIT;
+		return true;
+	}
+	sendRequestAsync();
+	PN5180DEBUG_EXIT;
+	return isBusy();
+}
+
+/*
+ * Advance the transaction of startActivateTypeA() by at most one frame,
+ * never waits for the card. Returns true while the transaction is running.
+ */
+bool PN5180ISO14443::poll() {
+	int8_t rx;
+	switch (asyncStep) {
+		case PN5180_ACTIVATE_IDLE:
+			return false;
+
+		case PN5180_ACTIVATE_RF_RAMP:
+			if (micros() - asyncStartedUs < 10000UL) return true;  // wait RF-field to ramp-up
+			sendRequestAsync();
+			break;
+
+		case PN5180_ACTIVATE_WAIT_ATQA:
+			rx = pollIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US);
+			if (rx == 0) return true;
+			recordPhase(PN5180_PHASE_REQA, asyncStartedUs);
+			// no answer means no card
+			if (rx < 0) {
+				finishActivate(0);
+				break;
+			}
+			if (!readData(2, asyncBuffer)) {
+				finishActivate(-1);
+				break;
+			}
+			asyncStep = PN5180_ACTIVATE_WAIT_TRANSMIT;
+			asyncStartedUs = micros();
+			break;
+
+		case PN5180_ACTIVATE_WAIT_TRANSMIT:
+			if (PN5180_TS_WaitTransmit != getTransceiveState()) {
+				if (micros() - asyncStartedUs > 200000UL) {
+					PN5180DEBUG_PRINTLN(F("*** ERROR: timeout in PN5180_TS_WaitTransmit!"));
+					finishActivate(-1);
+					break;
+				}
+				return true;
+			}
+			// send Anti collision of the first level, 8 bits in last byte
+			asyncCmd[0] = 0x93;
+			asyncCmd[1] = 0x20;
+			if (!sendAsync(2, 0x00, PN5180_ACTIVATE_WAIT_UID)) finishActivate(-1);
+			break;
+
+		case PN5180_ACTIVATE_WAIT_UID:
+			rx = pollIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US);
+			if (rx == 0) return true;
+			// read 5 bytes UID/CT + BCC, stored at offset 2 for the select
+			if ((rx < 0) || (rxBytesReceived() != 5)) {
+				finishActivate(-2);
+				break;
+			}
+			if (!readData(5, asyncCmd + 2)) {
+				finishActivate(-1);
+				break;
+			}
+			recordPhase(PN5180_PHASE_ANTICOLLISION, asyncStartedUs);
+			// CRC is switched on now, next poll has to restore the idle setup
+			protocolPrepared = false;
+			if (!enableCRC(true)) {
+				finishActivate(-1);
+				break;
+			}
+			asyncCmd[0] = (asyncLevel == 0) ? 0x93 : 0x95;
+			asyncCmd[1] = 0x70;
+			if (!sendAsync(7, 0x00, PN5180_ACTIVATE_WAIT_SAK)) finishActivate(-1);
+			break;
+
+		case PN5180_ACTIVATE_WAIT_SAK:
+			rx = pollIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US);
+			if (rx == 0) return true;
+			//Read 1 byte SAK into buffer[2]
+			if (rx < 0) {
+				finishActivate(-2);
+				break;
+			}
+			if (!readData(1, asyncBuffer + 2)) {
+				finishActivate(-1);
+				break;
+			}
+			recordPhase(PN5180_PHASE_SELECT, asyncStartedUs);
+			if ((asyncBuffer[2] & 0x04) == 0) {
+				// last cascade level, 4 UID bytes follow the first level's 3 (or 0) bytes
+				for (int i = 0; i < 4; i++) asyncBuffer[3 + 3 * asyncLevel + i] = asyncCmd[2 + i];
+				recordPhase(PN5180_PHASE_ACTIVATE, asyncStartedActivate);
+				finishActivate((asyncLevel == 0) ? 4 : 7);
+				break;
+			}
+			// Take First 3 bytes of UID, Ignore first byte 88(CT). Triple size UIDs do not
+			// fit into the buffer, same as activateTypeA()
+			if ((asyncLevel > 0) || (asyncCmd[2] != 0x88)) {
+				finishActivate((asyncLevel > 0) ? -2 : 0);
+				break;
+			}
+			for (int i = 0; i < 3; i++) asyncBuffer[3 + i] = asyncCmd[3 + i];
+			if (!enableCRC(false)) {
+				finishActivate(-1);
+				break;
+			}
+			// Do anti collision 2
+			asyncLevel++;
+			asyncCmd[0] = 0x95;
+			asyncCmd[1] = 0x20;
+			if (!sendAsync(2, 0x00, PN5180_ACTIVATE_WAIT_UID)) finishActivate(-1);
+			break;
+	}
+	return isBusy();
+}
+
+/*
+ * Abort the transaction of startActivateTypeA(), the callback is not called
+ */
+void PN5180ISO14443::cancel() {
+	if (!isBusy()) return;
+	asyncStep = PN5180_ACTIVATE_IDLE;
+	asyncResult = -1;
+	// CRC state of an aborted select is unknown
+	protocolPrepared = false;
+}
+
+/*
+ * Non-blocking check of the IRQ status:
+ * returns 1 if an IRQ of irqMask is set, 0 while waiting, -1 after timeoutUs
+ */
+int8_t PN5180ISO14443::pollIRQ(uint32_t irqMask, uint32_t timeoutUs) {
+	if (getIRQStatus() & irqMask) return 1;
+	return (micros() - asyncStartedUs > timeoutUs) ? -1 : 0;
+}
+
+/*
+ * Restore the idle setup and send REQA/WUPA, 7 bits in last byte
+ */
+void PN5180ISO14443::sendRequestAsync() {
+	if (!prepareTypeA()) {
+		finishActivate(-1);
+		return;
+	}
+	asyncCmd[0] = (asyncKind == 0) ? 0x26 : 0x52;
+	if (!sendAsync(1, 0x07, PN5180_ACTIVATE_WAIT_ATQA)) {
+		protocolPrepared = false;
+		finishActivate(-1);
+	}
+}
+
+/*
+ * Send asyncCmd and continue with step next, without waiting for the answer
+ */
+bool PN5180ISO14443::sendAsync(uint8_t len, uint8_t validBits, PN5180ActivateStep next) {
+	clearIRQStatus(0xffffffff);
+	asyncStartedUs = micros();
+	if (!sendData(asyncCmd, len, validBits)) return false;
+	asyncStep = next;
+	return true;
+}
+
+void PN5180ISO14443::finishActivate(int8_t result) {
+	asyncStep = PN5180_ACTIVATE_IDLE;
+	asyncResult = result;
+	if (asyncCallback) {
+		asyncCallback(result, asyncBuffer, asyncContext);
+	}
+}
+
+bool PN5180ISO14443::mifareBlockRead(uint8_t blockno, uint8_t *buffer) {
 	uint8_t cmd[2];
-	// Send mifare command 30,blockno
+	// Send mifare command 30,blockno, READ 16 bytes into buffer
 	cmd[0] = 0x30;
 	cmd[1] = blockno;
-	if (!sendData(cmd, 2, 0x00))
+	return transceiveTypeA(cmd, 2, buffer, 16, ISO14443_RX_TIMEOUT_US);
+}
+
+/*
+ * Send one frame with the current CRC/crypto settings and read a response
+ * of exactly len bytes into buffer, timeoutUs is the wait for the complete
+ * response.
+ */
+bool PN5180ISO14443::transceiveTypeA(const uint8_t *cmd, uint8_t cmdLen, uint8_t *buffer, uint16_t len, uint32_t timeoutUs) {
+	clearIRQStatus(0xffffffff);
+	if (!sendData(cmd, cmdLen, 0x00))
 	  return false;
 	//Check if we have received any data from the tag
-	delay(5);
-	len = rxBytesReceived();
-	if (len == 16) {
-		// READ 16 bytes into  buffer
-		if (readData(16, buffer))
-		  success = true;
-	}
-	return success;
+	if (!waitForIRQ(RX_IRQ_STAT, timeoutUs))
+	  return false;
+	if (rxBytesReceived() != len)
+	  return false;
+	return readData(len, buffer);
 }
 
 
+/*
+ * Mifare WRITE of 16 bytes, returns the 4 bit ACK (0x0A) or NAK of the card,
+ * 0xFF if the card did not answer or the reader failed.
+ */
 uint8_t PN5180ISO14443::mifareBlockWrite16(uint8_t blockno, const uint8_t *buffer) {
 	uint8_t cmd[2];
+	uint8_t ack = 0xFF;
 	// Clear RX CRC
 	writeRegisterWithAndMask(CRC_RX_CONFIG, 0xFFFFFFFE);
 
 	// Mifare write part 1
+	clearIRQStatus(0xffffffff);
 	cmd[0] = 0xA0;
 	cmd[1] = blockno;
-	sendData(cmd, 2, 0x00);
-	readData(1, cmd);
-
-	// Mifare write part 2
-	sendData(buffer,16, 0x00);
-	delay(10);
-
-	// Read ACK/NAK
-	readData(1, cmd);
+	if (sendData(cmd, 2, 0x00) && waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US) && readData(1, &ack) && (ack == 0x0A)) {
+		// Mifare write part 2
+		ack = 0xFF;
+		clearIRQStatus(0xffffffff);
+		// Read ACK/NAK
+		if (!sendData(buffer, 16, 0x00) || !waitForIRQ(RX_IRQ_STAT, ISO14443_WRITE_TIMEOUT_US) || !readData(1, &ack)) {
+			ack = 0xFF;
+		}
+	}
 
 	//Enable RX CRC calculation
 	writeRegisterWithOrMask(CRC_RX_CONFIG, 0x1);
-	return cmd[0];
+	return ack;
 }
 
 bool PN5180ISO14443::mifareHalt() {
 	uint8_t cmd[2];
 	//mifare Halt
+	mifareAuthSector = 0xFF;
 	cmd[0] = 0x50;
 	cmd[1] = 0x00;
 	sendData(cmd, 2, 0x00);	
 	return true;
 }
 
+/*
+ * Key table of mifareAuthenticateSector(), keyType 0x60 = key A, 0x61 = key B.
+ * Returns false if the table is full or the key type is invalid.
+ */
+bool PN5180ISO14443::addMifareKey(const uint8_t *key, uint8_t keyType) {
+	if ((mifareKeyCount >= PN5180_MIFARE_KEYS) || ((keyType != 0x60) && (keyType != 0x61))) {
+		return false;
+	}
+	mifareKeys[mifareKeyCount][0] = keyType;
+	memcpy(&mifareKeys[mifareKeyCount][1], key, 6);
+	mifareKeyCount++;
+	return true;
+}
+
+void PN5180ISO14443::clearMifareKeys() {
+	mifareKeyCount = 0;
+	mifareAuthSector = 0xFF;
+}
+
+/*
+ * Switch crypto off and select the card again with its known UID,
+ * needed after a failed authentication or read, the card is IDLE then.
+ */
+bool PN5180ISO14443::mifareReselect(const uint8_t *uid, uint8_t uidLength) {
+	mifareAuthSector = 0xFF;
+	if (!writeRegisterWithAndMask(SYSTEM_CONFIG, 0xFFFFFFBF)) {  // OFF Crypto
+		return false;
+	}
+	return isCardPresent(uid, uidLength);
+}
+
+/*
+ * Authenticate a Mifare Classic sector (0..39) with the key table.
+ * The sector authenticated last is remembered until the next activation,
+ * so reading it again costs no RF traffic. Keys are tried most recently
+ * successful first, the key that fits moves to the front: cards of one
+ * system usually share their keys, so the first try fits.
+ * For 7 byte UIDs the last 4 UID bytes are used.
+ * Returns 0 if authenticated, -1 if no key fits, -2 if the card was lost
+ * while reselecting it after a wrong key, -3 on reader errors.
+ */
+int16_t PN5180ISO14443::mifareAuthenticateSector(uint8_t sector, const uint8_t *uid, uint8_t uidLength) {
+	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::mifareAuthenticateSector(sector, *uid, uidLength)"));
+	PN5180DEBUG_ENTER;
+
+	if (sector == mifareAuthSector) {
+		PN5180DEBUG_EXIT;
+		return 0;
+	}
+	mifareAuthSector = 0xFF;
+	uint8_t trailer = (sector < 32) ? (sector * 4 + 3) : (128 + (sector - 32) * 16 + 15);
+	for (uint8_t i = 0; i < mifareKeyCount; i++) {
+		// a wrong key leaves the card IDLE
+		if ((i > 0) && !mifareReselect(uid, uidLength)) {
+			PN5180DEBUG_EXIT;
+			return -2;
+		}
+		int16_t status = mifareAuthenticate(trailer, &mifareKeys[i][1], mifareKeys[i][0], uid + uidLength - 4);
+		if (status < 0) {
+			PN5180DEBUG_EXIT;
+			return -3;
+		}
+		if (status == 0) {
+			if (i > 0) {
+				uint8_t found[7];
+				memcpy(found, mifareKeys[i], sizeof(found));
+				memmove(mifareKeys[1], mifareKeys[0], i * sizeof(found));
+				memcpy(mifareKeys[0], found, sizeof(found));
+			}
+			mifareAuthSector = sector;
+			PN5180DEBUG_EXIT;
+			return 0;
+		}
+	}
+	// leave the card selected for the next sector
+	if (mifareKeyCount > 0) {
+		mifareReselect(uid, uidLength);
+	}
+	PN5180DEBUG_EXIT;
+	return -1;
+}
+
+/*
+ * Read numBlocks Mifare Classic blocks from firstBlock into buffer (16 bytes
+ * per block), authenticating each sector once with the key table.
+ * Stops at the first sector without a fitting key or a failed read,
+ * the card is left selected for the next call.
+ * Returns the number of blocks read.
+ */
+int16_t PN5180ISO14443::mifareClassicRead(const uint8_t *uid, uint8_t uidLength, uint8_t firstBlock, uint8_t numBlocks, uint8_t *buffer) {
+	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::mifareClassicRead(*uid, uidLength, firstBlock, numBlocks, *buffer)"));
+	PN5180DEBUG_ENTER;
+
+	int16_t blocks = 0;
+	for (uint16_t block = firstBlock; (blocks < numBlocks) && (block < 256); block++) {
+		uint8_t sector = (block < 128) ? (block / 4) : (32 + (block - 128) / 16);
+		if (mifareAuthenticateSector(sector, uid, uidLength) != 0) {
+			break;
+		}
+		if (!mifareBlockRead(block, buffer + 16 * blocks)) {
+			// access bits deny the read, the card is IDLE now: crypto off and
+			// select it again, the next authentication starts from a known state
+			mifareReselect(uid, uidLength);
+			break;
+		}
+		blocks++;
+	}
+	PN5180DEBUG_EXIT;
+	return blocks;
+}
+
+/*
+ * Read numPages NTAG/Ultralight pages from firstPage into buffer (4 bytes
+ * per page). FAST_READ (NTAG21x, Ultralight EV1) returns up to
+ * PN5180_FAST_READ_MAX_PAGES pages per frame. Cards without FAST_READ
+ * answer with a NAK and are selected again, the rest is read with
+ * READ, 4 pages per frame.
+ * Returns the number of pages read.
+ */
+int16_t PN5180ISO14443::ntagReadPages(const uint8_t *uid, uint8_t uidLength, uint8_t firstPage, uint8_t numPages, uint8_t *buffer) {
+	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::ntagReadPages(*uid, uidLength, firstPage, numPages, *buffer)"));
+	PN5180DEBUG_ENTER;
+
+	if (firstPage + numPages > 256) {
+		numPages = 256 - firstPage;
+	}
+	uint8_t cmd[3];
+	int16_t pages = 0;
+	bool fastRead = true;
+	while (pages < numPages) {
+		uint8_t page = firstPage + pages;
+		uint8_t count = numPages - pages;
+		if (fastRead) {
+			if (count > PN5180_FAST_READ_MAX_PAGES) count = PN5180_FAST_READ_MAX_PAGES;
+			cmd[0] = 0x3A;
+			cmd[1] = page;
+			cmd[2] = page + count - 1;
+			// ~85us per byte at 106 kbit/s
+			if (transceiveTypeA(cmd, 3, buffer + 4 * pages, 4 * count, ISO14443_RX_TIMEOUT_US + 100UL * 4 * count)) {
+				pages += count;
+				continue;
+			}
+			fastRead = false;
+			if (!mifareReselect(uid, uidLength)) {
+				break;
+			}
+			continue;
+		}
+		// READ returns 4 pages, pages past numPages are dropped
+		uint8_t block[16];
+		cmd[0] = 0x30;
+		cmd[1] = page;
+		if (!transceiveTypeA(cmd, 2, block, 16, ISO14443_RX_TIMEOUT_US)) {
+			break;
+		}
+		if (count > 4) count = 4;
+		memcpy(buffer + 4 * pages, block, 4 * count);
+		pages += count;
+	}
+	PN5180DEBUG_EXIT;
+	return pages;
+}
+
 int8_t PN5180ISO14443::readCardSerial(uint8_t *buffer) {
 	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::readCardSerial(*buffer)"));
 	PN5180DEBUG_ENTER;
@@ -386,41 +979,9 @@ int8_t PN5180ISO14443::readCardSerial(uint8_t *buffer) {
 	  PN5180DEBUG_EXIT;
 	  return 0;
 	}
-	if ((response[0] == 0xFF) && (response[1] == 0xFF))
-	  uidLength = 0;
-	
-	// first UID byte should not be 0x00
-	// explicitly allow unknown manufacturer ID 0xFF
-	if (response[3] == 0x00)  
-		uidLength = 0;
-		
-	// check for valid uid, skip first byte (0x04)
-	// 0x04 0x00 0xFF 0x00 => invalid uid
-	bool validUID = false;
-	for (int i = 1; i < uidLength; i++) {
-		if ((response[i+3] != 0x00) && (response[i+3] != 0xFF)) {
-			validUID = true;
-			break;
-		}
-	}
-	if (uidLength == 4) {
-		if ((response[3] == 0x88)) {
-			// must not be the CT-flag (0x88)!
-			validUID = false;
-		};
-	}
-	if (uidLength == 7) {
-		if ((response[6] == 0x88)) {
-			// must not be the CT-flag (0x88)!
-			validUID = false;
-		};
-		if ((response[6] == 0x00) && (response[7] == 0x00) && (response[8] == 0x00) && (response[9] == 0x00)) {
-			validUID = false;
-		};
-		if ((response[6] == 0xFF) && (response[7] == 0xFF) && (response[8] == 0xFF) && (response[9] == 0xFF)) {
-			validUID = false;
-		};
-	};
+	// ATQA, manufacturer byte, cascade tag and 0x00/0xFF patterns
+	uint16_t atqa = response[0] | (response[1] << 8);
+	bool validUID = PN5180IsValidATQA(atqa) && PN5180IsValidUID(&response[3], uidLength);
 //	mifareHalt();
 	if (validUID) {
 		for (int i = 0; i < uidLength; i++) buffer[i] = response[i+3];
@@ -444,3 +1005,133 @@ bool PN5180ISO14443::isCardPresent() {
 	return ret;
 }
 
+/*
+ * Check that the card with the given UID (4, 7 or 10 bytes, no cascade tags)
+ * from a previous activateTypeA() is still in the field, without anticollision:
+ * HLTA puts the active card to HALT, WUPA wakes it up and the card is
+ * selected directly with the known UID, one SELECT per cascade level.
+ * The card is in ACTIVE state again afterwards, so the next check works the same.
+ * Returns false if the RF field was switched off in between, the card does not
+ * answer or the SAK does not match, a full activateTypeA() is needed then.
+ */
+bool PN5180ISO14443::isCardPresent(const uint8_t *uid, uint8_t uidLength) {
+	PN5180DEBUG_PRINTLN(F("PN5180ISO14443::isCardPresent(*uid, uidLength)"));
+	PN5180DEBUG_ENTER;
+
+	uint8_t levels = (uidLength == 4) ? 1 : (uidLength == 7) ? 2 : (uidLength == 10) ? 3 : 0;
+	// a card in a switched off field is reset to IDLE
+	if ((0 == levels) || !isRFReady(0x00, 0x80)) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+	unsigned long startedCheck = micros();
+	uint8_t cmd[7];
+
+	// HLTA with CRC, the card does not answer
+	protocolPrepared = false;
+	mifareAuthSector = 0xFF;
+	if (!enableCRC(true)) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+	clearIRQStatus(0xffffffff);
+	cmd[0] = 0x50;
+	cmd[1] = 0x00;
+	if (!sendData(cmd, 2, 0x00) || !waitForIRQ(TX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+
+	// WUPA without CRC, 7 bits in last byte, wakes up the halted card
+	if (!enableCRC(false)) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+	clearIRQStatus(0xffffffff);
+	cmd[0] = 0x52;
+	if (!sendData(cmd, 1, 0x07) || !waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+		PN5180DEBUG_PRINTLN(F("No answer to WUPA, card removed"));
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+
+	// SELECT each cascade level with the known UID
+	if (!enableCRC(true)) {
+		PN5180DEBUG_EXIT;
+		return false;
+	}
+	static const uint8_t selectCmd[3] = { 0x93, 0x95, 0x97 };
+	uint8_t offset = 0;
+	for (uint8_t level = 0; level < levels; level++) {
+		bool lastLevel = (level == levels - 1);
+		cmd[0] = selectCmd[level];
+		cmd[1] = 0x70;
+		if (lastLevel) {
+			for (int i = 0; i < 4; i++) cmd[2 + i] = uid[offset + i];
+		}
+		else {
+			cmd[2] = 0x88;  // cascade tag
+			for (int i = 0; i < 3; i++) cmd[3 + i] = uid[offset + i];
+			offset += 3;
+		}
+		cmd[6] = cmd[2] ^ cmd[3] ^ cmd[4] ^ cmd[5];  // BCC
+
+		clearIRQStatus(0xffffffff);
+		if (!sendData(cmd, 7, 0x00) || !waitForIRQ(RX_IRQ_STAT, ISO14443_RX_TIMEOUT_US)) {
+			PN5180DEBUG_EXIT;
+			return false;
+		}
+		uint8_t sak;
+		if ((rxBytesReceived() != 1) || !readData(1, &sak)) {
+			PN5180DEBUG_EXIT;
+			return false;
+		}
+		// cascade bit must be set on all but the last level
+		if (((sak & 0x04) != 0) == lastLevel) {
+			PN5180DEBUG_EXIT;
+			return false;
+		}
+	}
+
+	recordPhase(PN5180_PHASE_PRESENCE, startedCheck);
+	PN5180DEBUG_EXIT;
+	return true;
+}
+
+bool PN5180ISO14443Poller::addReader(PN5180ISO14443 &reader) {
+	if (count >= PN5180_POLLER_MAX_READERS) return false;
+	readers[count++] = &reader;
+	return true;
+}
+
+void PN5180ISO14443Poller::setCallback(PN5180PollerCallback callback, void *context) {
+	this->callback = callback;
+	this->context = context;
+}
+
+void PN5180ISO14443Poller::start(uint8_t kind) {
+	for (uint8_t i = 0; i < count; i++) {
+		if (!readers[i]->isBusy()) {
+			readers[i]->startActivateTypeA(buffers[i], kind, onActivated, this);
+		}
+	}
+}
+
+bool PN5180ISO14443Poller::poll() {
+	bool busy = false;
+	for (uint8_t i = 0; i < count; i++) {
+		if (readers[i]->poll()) busy = true;
+	}
+	return busy;
+}
+
+/*
+ * Completion of one reader, the reader is identified by its buffer
+ */
+void PN5180ISO14443Poller::onActivated(int8_t uidLength, uint8_t *buffer, void *context) {
+	PN5180ISO14443Poller *poller = (PN5180ISO14443Poller *)context;
+	uint8_t index = (uint8_t)((buffer - poller->buffers[0]) / sizeof(poller->buffers[0]));
+	if (poller->callback) {
+		poller->callback(index, uidLength, buffer, poller->context);
+	}
+}
@@ -20,7 +20,31 @@
 #define PN5180ISO14443_H
 
 #include "PN5180.h"
+#include "PN5180CardType.h"
 
+/*
+ * Steps of the asynchronous activateTypeA(), see startActivateTypeA()
+ */
+enum PN5180ActivateStep {
+  PN5180_ACTIVATE_IDLE = 0,        // no transaction, result is valid
+  PN5180_ACTIVATE_RF_RAMP,         // RF field switched on, waiting for ramp-up
+  PN5180_ACTIVATE_WAIT_ATQA,       // REQA/WUPA sent
+  PN5180_ACTIVATE_WAIT_TRANSMIT,   // ATQA received, waiting for PN5180_TS_WaitTransmit
+  PN5180_ACTIVATE_WAIT_UID,        // anti collision of asyncLevel sent
+  PN5180_ACTIVATE_WAIT_SAK         // select of asyncLevel sent
+};
+
+/*
+ * Mifare Classic keys of the bulk read key table
+ */
+#ifndef PN5180_MIFARE_KEYS
+#define PN5180_MIFARE_KEYS (8)
+#endif
+// NTAG FAST_READ pages per frame, 504 bytes fit the 508 byte reception buffer
+#define PN5180_FAST_READ_MAX_PAGES (126)
+
+// called by poll() with the result of activateTypeA() and its buffer
+typedef void (*PN5180ActivateCallback)(int8_t uidLength, uint8_t *buffer, void *context);
 
 class PN5180ISO14443 : public PN5180 {
 
@@ -29,13 +53,50 @@ public:
   
 private:
   uint16_t rxBytesReceived();
+  bool enableCRC(bool on);
+  bool prepareTypeA();
+  bool anticollisionLevel(uint8_t level, uint8_t *uidPart);
+  // asynchronous activateTypeA()
+  int8_t pollIRQ(uint32_t irqMask, uint32_t timeoutUs);
+  void sendRequestAsync();
+  bool sendAsync(uint8_t len, uint8_t validBits, PN5180ActivateStep next);
+  void finishActivate(int8_t result);
+  PN5180ActivateStep asyncStep = PN5180_ACTIVATE_IDLE;
+  uint8_t *asyncBuffer = 0;
+  uint8_t asyncCmd[7];
+  uint8_t asyncKind = 0;
+  uint8_t asyncLevel = 0;
+  int8_t asyncResult = 0;
+  unsigned long asyncStartedUs = 0;      // start of the current step
+  unsigned long asyncStartedActivate = 0;
+  PN5180ActivateCallback asyncCallback = 0;
+  void *asyncContext = 0;
   uint32_t GetNumberOfBytesReceivedAndValidBits();
+  // bulk reads
+  bool transceiveTypeA(const uint8_t *cmd, uint8_t cmdLen, uint8_t *buffer, uint16_t len, uint32_t timeoutUs);
+  bool mifareReselect(const uint8_t *uid, uint8_t uidLength);
+  uint8_t mifareKeys[PN5180_MIFARE_KEYS][7];  // key type, 6 key bytes, most recent success first
+  uint8_t mifareKeyCount = 0;
+  uint8_t mifareAuthSector = 0xFF;            // sector authenticated since the last activation
 public:
   // Mifare TypeA
   int8_t activateTypeA(uint8_t *buffer, uint8_t kind);
+  int8_t getInventoryTypeA(uint8_t *uid, uint8_t *uidLength, uint8_t maxCards);
+  // non-blocking activateTypeA(), advanced by poll()
+  bool startActivateTypeA(uint8_t *buffer, uint8_t kind, PN5180ActivateCallback callback = 0, void *context = 0);
+  bool poll();
+  bool isBusy() const { return asyncStep != PN5180_ACTIVATE_IDLE; }
+  int8_t activateResult() const { return asyncResult; }
+  void cancel();
   bool mifareBlockRead(uint8_t blockno,uint8_t *buffer);
   uint8_t mifareBlockWrite16(uint8_t blockno, const uint8_t *buffer);
   bool mifareHalt();
+  // bulk reads of a card activated with activateTypeA()
+  bool addMifareKey(const uint8_t *key, uint8_t keyType = 0x60);
+  void clearMifareKeys();
+  int16_t mifareAuthenticateSector(uint8_t sector, const uint8_t *uid, uint8_t uidLength);
+  int16_t mifareClassicRead(const uint8_t *uid, uint8_t uidLength, uint8_t firstBlock, uint8_t numBlocks, uint8_t *buffer);
+  int16_t ntagReadPages(const uint8_t *uid, uint8_t uidLength, uint8_t firstPage, uint8_t numPages, uint8_t *buffer);
   /*
    * Helper functions
    */
@@ -43,6 +104,39 @@ public:
   bool setupRF();
   int8_t readCardSerial(uint8_t *buffer);    
   bool isCardPresent();    
+  bool isCardPresent(const uint8_t *uid, uint8_t uidLength);
+};
+
+/*
+ * Round-robin activation on several readers, e.g. on one shared SPI bus:
+ * while one reader waits for its card, poll() sends the frames of the
+ * others, so a round over all readers takes about as long as one activation.
+ */
+#define PN5180_POLLER_MAX_READERS (4)
+
+// called by poll() for every reader that finished its activation
+typedef void (*PN5180PollerCallback)(uint8_t reader, int8_t uidLength, uint8_t *buffer, void *context);
+
+class PN5180ISO14443Poller {
+public:
+  bool addReader(PN5180ISO14443 &reader);
+  void setCallback(PN5180PollerCallback callback, void *context = 0);
+  uint8_t size() const { return count; }
+  PN5180ISO14443 &reader(uint8_t index) { return *readers[index]; }
+
+  /* start the activation on all idle readers, kind as in activateTypeA() */
+  void start(uint8_t kind = 0);
+  /* one step on every busy reader, true while any reader is busy */
+  bool poll();
+
+private:
+  PN5180ISO14443 *readers[PN5180_POLLER_MAX_READERS];
+  uint8_t buffers[PN5180_POLLER_MAX_READERS][10];
+  uint8_t count = 0;
+  PN5180PollerCallback callback = 0;
+  void *context = 0;
+
+  static void onActivated(int8_t uidLength, uint8_t *buffer, void *context);
 };
 
 #endif /* PN5180ISO14443_H */
@@ -22,6 +22,21 @@
 #include "PN5180ISO15693.h"
 #include "Debug.h"
 
+// max. time to wait for the start of a tag response
+#ifndef ISO15693_SOF_TIMEOUT_US
+#define ISO15693_SOF_TIMEOUT_US  (10000)
+#endif
+// max. time to send a request, 16 slot inventory with 64 bit mask + CRC is ~4.2ms at 26 kbit/s
+#ifndef ISO15693_TX_TIMEOUT_US
+#define ISO15693_TX_TIMEOUT_US   (6000)
+#endif
+// max. time from the end of a request or EOF to a response in an inventory time slot (t1 is ~320us)
+#ifndef ISO15693_SLOT_TIMEOUT_US
+#define ISO15693_SLOT_TIMEOUT_US (1000)
+#endif
+// data bytes of one response: 508 byte reception buffer minus the response flags
+#define ISO15693_MAX_RX_DATA     (507)
+
 PN5180ISO15693::PN5180ISO15693(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi) 
               : PN5180(SSpin, BUSYpin, RSTpin, spi) {
 }
@@ -69,69 +84,107 @@ ISO15693ErrorCode PN5180ISO15693::getInventory(uint8_t *uid) {
   return ISO15693_EC_OK;
 }
 
+/*
+ * Pending inventory masks, handled in FIFO order
+ */
+bool ISO15693MaskQueue::push(uint64_t value, uint8_t length) {
+  if (count >= ISO15693_INVENTORY_QUEUE_SIZE) {
+    dropped++;
+    return false;
+  }
+  uint8_t tail = (head + count) % ISO15693_INVENTORY_QUEUE_SIZE;
+  masks[tail].value = value;
+  masks[tail].length = length;
+  count++;
+  return true;
+}
+
+bool ISO15693MaskQueue::pop(ISO15693InventoryMask &mask) {
+  if (count == 0) return false;
+  mask = masks[head];
+  head = (head + 1) % ISO15693_INVENTORY_QUEUE_SIZE;
+  count--;
+  return true;
+}
+
 /*
  * Inventory with flag set for 16 time slots, code=01
  * https://www.nxp.com.cn/docs/en/application-note/AN12650.pdf
  * Request format: SOF, Req.Flags, Inventory, AFI (opt.), Mask len, Mask value, CRC16, EOF
  * Response format: SOF, Resp.Flags, DSFID, UID, CRC16, EOF
  *
+ * A collision in a slot queues the mask extended by the slot number,
+ * every queued mask is polled once. maxMillis = 0 polls until the
+ * queue is empty or maxTags are found.
+ *
+ * return value:
+ * - ISO15693_EC_OK all tags found
+ * - EC_INVENTORY_INCOMPLETE masks left unpolled (time limit, maxTags or full queue)
  */
-ISO15693ErrorCode PN5180ISO15693::getInventoryMultiple(uint8_t *uid, uint8_t maxTags, uint8_t *numCard) {
-  PN5180DEBUG_PRINTF("PN5180ISO15693::getInventoryMultiple(maxTags=%d, numCard=%d)", maxTags, *numCard);
+ISO15693ErrorCode PN5180ISO15693::getInventoryMultiple(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, uint16_t maxMillis) {
+  PN5180DEBUG_PRINTF("PN5180ISO15693::getInventoryMultiple(maxTags=%d, maxMillis=%d)", maxTags, maxMillis);
   PN5180DEBUG_PRINTLN();
   PN5180DEBUG_ENTER;
-  uint16_t collision[maxTags];
+  unsigned long startedInventory = millis();
+  ISO15693MaskQueue pending;
+  ISO15693InventoryMask mask = { 0, 0 };
   *numCard = 0;
-  uint8_t numCol = 0;
-  inventoryPoll(uid, maxTags, numCard, &numCol, collision);
-  PN5180DEBUG_PRINTF("*** Number of collisions=%d", numCol);
-  PN5180DEBUG_PRINTLN();
 
-  while(numCol){                                                 // 5+ Continue until no collisions detected
+  ISO15693ErrorCode rc = inventoryPoll(uid, maxTags, numCard, mask, pending);
+  while ((ISO15693_EC_OK == rc) && (*numCard < maxTags)) {        // 5+ Continue until no collisions detected
+    if ((maxMillis > 0) && (millis() - startedInventory >= maxMillis)) break;
+    if (!pending.pop(mask)) break;
 #ifdef DEBUG
-    PN5180DEBUG(F("Polling with mask=0x"));
-    PN5180DEBUG(formatHex(collision[0]));
+    PN5180DEBUG_PRINTF(F("Polling with mask=0x%08lX%08lX, maskLen=%d, pending=%d"),
+                       (unsigned long)(mask.value >> 32), (unsigned long)mask.value, mask.length, pending.size());
     PN5180DEBUG_PRINTLN();
 #endif
-    inventoryPoll(uid, maxTags, numCard, &numCol, collision);
-    numCol--;
-    for(int i=0; i<numCol; i++){
-      collision[i] = collision[i+1];
-    }
+    rc = inventoryPoll(uid, maxTags, numCard, mask, pending);
   }
+  PN5180DEBUG_PRINTF("*** Number of cards=%d, unpolled masks=%d, dropped masks=%d", *numCard, pending.size(), pending.dropped);
+  PN5180DEBUG_PRINTLN();
   PN5180DEBUG_EXIT;
-  return ISO15693_EC_OK;
+  if ((ISO15693_EC_OK == rc) && ((pending.size() > 0) || (pending.dropped > 0))) {
+    return EC_INVENTORY_INCOMPLETE;
+  }
+  return rc;
 }
 
-ISO15693ErrorCode PN5180ISO15693::inventoryPoll(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, uint8_t *numCol, uint16_t *collision){
-  PN5180DEBUG_PRINTF("PN5180ISO15693::inventoryPoll(maxTags=%d, numCard=%d, numCol=%d)", maxTags, *numCard, *numCol);
+ISO15693ErrorCode PN5180ISO15693::inventoryPoll(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, const ISO15693InventoryMask &mask, ISO15693MaskQueue &pending){
+  PN5180DEBUG_PRINTF("PN5180ISO15693::inventoryPoll(maxTags=%d, numCard=%d, maskLen=%d)", maxTags, *numCard, mask.length);
   PN5180DEBUG_PRINTLN();
   PN5180DEBUG_ENTER;
   
-  uint8_t maskLen = 0;
-  if(*numCol > 0){
-    uint32_t mask = collision[0];
-    do{
-      mask >>= 4L;
-      maskLen++;
-    }while(mask > 0);
-  } 
-  uint8_t *p = (uint8_t*)&(collision[0]);
-  //                      Flags,  CMD,
-  const uint8_t inventory[7] = { 0x06, 0x01, uint8_t(maskLen*4), p[0], p[1], p[2], p[3] };
-  //                         |\- inventory flag + high data rate
-  //                         \-- 16 slots: upto 16 cards, no AFI field present
-  uint8_t cmdLen = 3 + (maskLen/2) + (maskLen%2);
+  //                   Flags,  CMD, mask len, mask value (LSB first, upto 8 bytes)
+  uint8_t inventory[3 + 8] = { 0x06, 0x01, mask.length };
+  //                   |\- inventory flag + high data rate
+  //                   \-- 16 slots: upto 16 cards, no AFI field present
+  uint8_t maskBytes = (mask.length + 7) / 8;
+  for (uint8_t i = 0; i < maskBytes; i++) {
+    inventory[3 + i] = (uint8_t)(mask.value >> (8 * i));
+  }
+  uint8_t cmdLen = 3 + maskBytes;
 #ifdef DEBUG
-  PN5180DEBUG_PRINTF(F("mask=%d, maskLen=%d, cmdLen=%d"), p[0], maskLen, cmdLen);
+  PN5180DEBUG_PRINTF(F("maskLen=%d, cmdLen=%d"), mask.length, cmdLen);
   PN5180DEBUG_PRINTLN();
 #endif
+  ISO15693ErrorCode rc = ISO15693_EC_OK;
   clearIRQStatus(0x000FFFFF);                                      // 3. Clear all IRQ_STATUS flags
-  sendData(inventory, cmdLen, 0);                                  // 4. 5. 6. Idle/StopCom Command, Transceive Command, Inventory command
+  // 4. 5. 6. Idle/StopCom Command, Transceive Command, Inventory command,
+  // the slot timeout starts at the end of the RF transmission
+  if (!sendData(inventory, cmdLen, 0) || !waitForIRQ(TX_IRQ_STAT, ISO15693_TX_TIMEOUT_US)) {
+    PN5180DEBUG(F("ERROR sending inventory request!"));
+    PN5180DEBUG_PRINTLN();
+    rc = ISO15693_EC_UNKNOWN_ERROR;
+  }
   
-  for(uint8_t slot=0; slot<16; slot++){                                // 7. Loop to check 16 time slots for data
+  for(uint8_t slot=0; (slot<16) && (ISO15693_EC_OK == rc); slot++){  // 7. Loop to check 16 time slots for data
     uint32_t rxStatus;
-    uint32_t irqStatus = getIRQStatus();
+    uint32_t irqStatus;
+    if (waitForIRQ(RX_SOF_DET_IRQ_STAT, ISO15693_SLOT_TIMEOUT_US)) {  // a tag answers in this slot
+      waitForIRQ(RX_IRQ_STAT, (uint32_t)commandTimeout * 1000UL);
+    }
+    irqStatus = getIRQStatus();
     readRegister(RX_STATUS, &rxStatus);
     PN5180DEBUG(F("slot="));
     PN5180DEBUG(formatHex(slot));
@@ -141,13 +194,15 @@ ISO15693ErrorCode PN5180ISO15693::inventoryPoll(uint8_t *uid, uint8_t maxTags, u
     PN5180DEBUG(F(", RX_STATUS="));
     PN5180DEBUG(formatHex(rxStatus));
     PN5180DEBUG(F(": "));
-    uint16_t len = (uint16_t)(rxStatus & 0x000001ff);
-    if((rxStatus >> 18) & 0x01 && *numCol < maxTags){              // 7+ Determine if a collision occurred
-      if(maskLen > 0) collision[*numCol] = collision[0] | (slot << (maskLen * 2));
-      else collision[*numCol] = slot << (maskLen * 2); // Yes, store position of collision
-      *numCol = *numCol + 1;
+    uint16_t len = (uint16_t)(rxStatus & RX_BYTES_RECEIVED_MASK);
+    if (rxStatus & RX_COLLISION_DETECTED) {                        // 7+ Determine if a collision occurred
+      // the slot number are the next 4 UID bits after the mask,
+      // a 60 bit mask plus slot would be the complete UID
+      if (mask.length + 4 < 64) {
+        pending.push(mask.value | ((uint64_t)slot << mask.length), mask.length + 4);
+      }
 #ifdef DEBUG
-      PN5180DEBUG_PRINTF("Collision detected for UIDs matching %X starting at LSB", collision[*numCol-1]);
+      PN5180DEBUG_PRINTF("Collision detected in slot %d, pending masks=%d", slot, pending.size());
       PN5180DEBUG_PRINTLN();
 #endif
     }
@@ -155,7 +210,7 @@ ISO15693ErrorCode PN5180ISO15693::inventoryPoll(uint8_t *uid, uint8_t maxTags, u
       PN5180DEBUG(F("No card in this time slot."));
       PN5180DEBUG_PRINTLN();
     }
-    else{
+    else if (*numCard < maxTags) {
 #ifdef DEBUG
       PN5180DEBUG_PRINTF("slot=%d, irqStatus: %ld, RX_STATUS: %ld, Response length=%d", slot, irqStatus, rxStatus, len);
 #endif
@@ -194,13 +249,18 @@ ISO15693ErrorCode PN5180ISO15693::inventoryPoll(uint8_t *uid, uint8_t maxTags, u
     if(slot+1 < 16){ // If we have more cards to poll for...
       writeRegisterWithAndMask(TX_CONFIG, 0xFFFFFB3F);             // 11. Next SEND_DATA will only include EOF
       clearIRQStatus(0x000FFFFF);                                  // 14. Clear all IRQ_STATUS flags
-      sendData(inventory, 0, 0);                                   // 12. 13. 15. Idle/StopCom Command, Transceive Command, Send EOF
+      // 12. 13. 15. Idle/StopCom Command, Transceive Command, Send EOF
+      if (!sendData(inventory, 0, 0) || !waitForIRQ(TX_IRQ_STAT, ISO15693_TX_TIMEOUT_US)) {
+        PN5180DEBUG(F("ERROR sending EOF!"));
+        PN5180DEBUG_PRINTLN();
+        rc = ISO15693_EC_UNKNOWN_ERROR;
+      }
     }
   }
   setRF_off();                                                     // 16. Switch off RF field
   setupRF();                                                       // 1. 2. Load ISO15693 config, RF on
   PN5180DEBUG_EXIT;
-  return ISO15693_EC_OK;
+  return rc;
 }
 
 /*
@@ -249,21 +309,18 @@ ISO15693ErrorCode PN5180ISO15693::readSingleBlock(const uint8_t *uid, uint8_t bl
   PN5180DEBUG_PRINTLN();
 #endif
 
-  uint8_t *resultPtr;
-  ISO15693ErrorCode rc = issueISO15693Command(readSingleBlock, sizeof(readSingleBlock), &resultPtr);
+  ISO15693ErrorCode rc = issueISO15693Command(readSingleBlock, sizeof(readSingleBlock), blockData, blockSize);
   if (ISO15693_EC_OK != rc) {
     return rc;
   }
 
+#ifdef DEBUG
   PN5180DEBUG("Value=");
-  
   for (int i=0; i<blockSize; i++) {
-    blockData[i] = resultPtr[1+i];
-#ifdef DEBUG    
     PN5180DEBUG(formatHex(blockData[i]));
     PN5180DEBUG(" ");
-#endif    
   }
+#endif
 
 #ifdef DEBUG
   PN5180DEBUG(" ");
@@ -380,11 +437,11 @@ ISO15693ErrorCode PN5180ISO15693::writeSingleBlock(const uint8_t *uid, uint8_t b
  *    SOF, Flags, BlockData (len=blockSize * numBlock), CRC16, EOF
  */
 ISO15693ErrorCode PN5180ISO15693::readMultipleBlock(const uint8_t *uid, uint8_t blockNo, uint8_t numBlock, uint8_t *blockData, uint8_t blockSize) {
-  if(blockNo > numBlock-1){ // Attempted to start at a block greater than the num blocks on the VICC
-    PN5180DEBUG("Starting block exceeds length of data");
-    return ISO15693_EC_BLOCK_NOT_AVAILABLE;
+  if ((0 == numBlock) || (0 == blockSize)) {
+    PN5180DEBUG("No blocks to read");
+    return ISO15693_EC_OPTION_NOT_SUPPORTED;
   }
-  if( (blockNo + numBlock) > numBlock ){ // Will attempt to read a block greater than the num blocks on the VICC 
+  if ((uint16_t)blockNo + numBlock > 256) { // block numbers are 8 bit
     PN5180DEBUG("End of block exceeds length of data");
     return ISO15693_EC_BLOCK_NOT_AVAILABLE;
   }
@@ -398,32 +455,38 @@ ISO15693ErrorCode PN5180ISO15693::readMultipleBlock(const uint8_t *uid, uint8_t
     readMultipleCmd[2+i] = uid[i];
   }
 
-  PN5180DEBUG("readMultipleBlock: Read Block #");
-  PN5180DEBUG(blockNo);
-  PN5180DEBUG("-");
-  PN5180DEBUG(blockNo+numBlock-1);
-  PN5180DEBUG(", blockSize=");
-  PN5180DEBUG(blockSize);
-  PN5180DEBUG(", Cmd: ");
-  for (int i=0; i<sizeof(readMultipleCmd); i++) {
-    PN5180DEBUG(" ");
-    PN5180DEBUG(formatHex(readMultipleCmd[i]));
-  }
+  // one response frame holds the flags and upto ISO15693_MAX_RX_DATA data bytes
+  uint8_t chunkBlocks = (ISO15693_MAX_RX_DATA / blockSize < numBlock) ? ISO15693_MAX_RX_DATA / blockSize : numBlock;
+  if (0 == chunkBlocks) return ISO15693_EC_OPTION_NOT_SUPPORTED;
+
+  for (uint16_t done = 0; done < numBlock; done += chunkBlocks) {
+    uint8_t count = (numBlock - done < chunkBlocks) ? numBlock - done : chunkBlocks;
+    readMultipleCmd[10] = blockNo + done;
+    readMultipleCmd[11] = count - 1;
+
+    PN5180DEBUG("readMultipleBlock: Read Block #");
+    PN5180DEBUG(blockNo + done);
+    PN5180DEBUG("-");
+    PN5180DEBUG(blockNo + done + count - 1);
+    PN5180DEBUG(", blockSize=");
+    PN5180DEBUG(blockSize);
+    PN5180DEBUG(", Cmd: ");
+    for (int i=0; i<sizeof(readMultipleCmd); i++) {
+      PN5180DEBUG(" ");
+      PN5180DEBUG(formatHex(readMultipleCmd[i]));
+    }
 
-  uint8_t *resultPtr;
-  ISO15693ErrorCode rc = issueISO15693Command(readMultipleCmd, sizeof(readMultipleCmd), &resultPtr);
-  if (ISO15693_EC_OK != rc) return rc;
+    ISO15693ErrorCode rc = issueISO15693Command(readMultipleCmd, sizeof(readMultipleCmd),
+                                                blockData + done * blockSize, (uint16_t)count * blockSize);
+    if (ISO15693_EC_OK != rc) return rc;
+  }
 
+#ifdef DEBUG
   PN5180DEBUG("readMultipleBlock: Value=");
   for (int i=0; i<numBlock * blockSize; i++) {
-    blockData[i] = resultPtr[1+i];
-#ifdef DEBUG    
     PN5180DEBUG(formatHex(blockData[i]));
     PN5180DEBUG(" ");
-#endif 
   }
-
-#ifdef DEBUG
   PN5180DEBUG(" ");
   for (int i=0; i<blockSize; i++) {
     char c = blockData[i];
@@ -726,29 +789,77 @@ ISO15693ErrorCode PN5180ISO15693::enablePrivacyMode(const uint8_t *password) {
  *   >0 = Error code
  */
 ISO15693ErrorCode PN5180ISO15693::issueISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint8_t **resultPtr) {
+  uint16_t len;
+  ISO15693ErrorCode rc = transceiveISO15693Command(cmd, cmdLen, &len);
+  if (ISO15693_EC_OK != rc) return rc;
+
+ *resultPtr = readData(len);
+  if (0L == *resultPtr) {
+    PN5180DEBUG(F("*** ERROR in readData!\n"));
+    return ISO15693_EC_UNKNOWN_ERROR;
+  }
+  
+#ifdef DEBUG
+  Serial.print("Read=");
+  for (int i=0; i<len; i++) {
+    Serial.print(formatHex((*resultPtr)[i]));
+    if (i<len-1) Serial.print(":");
+  }
+  Serial.println();
+#endif
+
+  return checkISO15693Response((*resultPtr)[0], (*resultPtr)[1]);
+}
+
+/*
+ * Same as above, but the response (without the response flags) is read
+ * directly into the caller's buffer, no copy and no heap buffer.
+ * A response shorter than resultLen is an error.
+ */
+ISO15693ErrorCode PN5180ISO15693::issueISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint8_t *result, uint16_t resultLen) {
+  uint16_t len;
+  ISO15693ErrorCode rc = transceiveISO15693Command(cmd, cmdLen, &len);
+  if (ISO15693_EC_OK != rc) return rc;
+  if (0 == len) return ISO15693_EC_UNKNOWN_ERROR;
+
+  uint8_t responseFlags;
+  uint16_t dataLen = (len - 1 < resultLen) ? len - 1 : resultLen;
+  if (!readData(&responseFlags, 1, result, dataLen)) {
+    PN5180DEBUG(F("*** ERROR in readData!\n"));
+    return ISO15693_EC_UNKNOWN_ERROR;
+  }
+
+  rc = checkISO15693Response(responseFlags, (dataLen > 0) ? result[0] : (uint8_t)ISO15693_EC_UNKNOWN_ERROR);
+  if ((ISO15693_EC_OK == rc) && (dataLen < resultLen)) {
+    PN5180DEBUG(F("*** ERROR: response too short!\n"));
+    return ISO15693_EC_UNKNOWN_ERROR;
+  }
+  return rc;
+}
+
+/*
+ * Send the command and wait for the complete response, len receives
+ * the number of bytes in the reception buffer
+ */
+ISO15693ErrorCode PN5180ISO15693::transceiveISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint16_t *len) {
 #ifdef DEBUG
   PN5180DEBUG(F("Issue Command 0x"));
   PN5180DEBUG(formatHex(cmd[1]));
   PN5180DEBUG("...\n");
 #endif
 
+  // all flags, waitForIRQ() stops at a stale GENERAL_ERROR_IRQ_STAT
+  clearIRQStatus(0x000FFFFF);
   sendData(cmd, cmdLen);
-  delay(10);
 
-  uint32_t irqR = getIRQStatus();
-  if (0 == (irqR & RX_SOF_DET_IRQ_STAT)) {
+  if (!waitForIRQ(RX_SOF_DET_IRQ_STAT, ISO15693_SOF_TIMEOUT_US)) {
     PN5180DEBUG("Didnt detect RX_SOF_DET_IRQ_STAT after sendData");
 	  return EC_NO_CARD;
   }
   
-  unsigned long startedWaiting = millis();
-  while(!(irqR & RX_IRQ_STAT)) {
-    irqR = getIRQStatus();
-    delay(1);
-    if (millis() - startedWaiting > commandTimeout) {
-      PN5180DEBUG("Didnt detect RX_IRQ_STAT after sendData");
-      return EC_NO_CARD;
-    }
+  if (!waitForIRQ(RX_IRQ_STAT, (uint32_t)commandTimeout * 1000UL)) {
+    PN5180DEBUG("Didnt detect RX_IRQ_STAT after sendData");
+    return EC_NO_CARD;
   }
   
   uint32_t rxStatus;
@@ -757,38 +868,26 @@ ISO15693ErrorCode PN5180ISO15693::issueISO15693Command(const uint8_t *cmd, uint8
   PN5180DEBUG(F("RX-Status="));
   PN5180DEBUG(formatHex(rxStatus));
 
-  uint16_t len = (uint16_t)(rxStatus & 0x000001ff);
+  *len = (uint16_t)(rxStatus & RX_BYTES_RECEIVED_MASK);
   
   PN5180DEBUG(", len=");
-  PN5180DEBUG(len);
+  PN5180DEBUG(*len);
   PN5180DEBUG_PRINTLN();
+  return ISO15693_EC_OK;
+}
 
- *resultPtr = readData(len);
-  if (0L == *resultPtr) {
-    PN5180DEBUG(F("*** ERROR in readData!\n"));
-    return ISO15693_EC_UNKNOWN_ERROR;
-  }
-  
-#ifdef DEBUG
-  Serial.print("Read=");
-  for (int i=0; i<len; i++) {
-    Serial.print(formatHex((*resultPtr)[i]));
-    if (i<len-1) Serial.print(":");
-  }
-  Serial.println();
-#endif
-
+/*
+ * Evaluate the response flags (and the error code) of a read response
+ */
+ISO15693ErrorCode PN5180ISO15693::checkISO15693Response(uint8_t responseFlags, uint8_t errorCode) {
   uint32_t irqStatus = getIRQStatus();
   if (0 == (RX_SOF_DET_IRQ_STAT & irqStatus)) { // no card detected
     PN5180DEBUG("Didnt detect RX_SOF_DET_IRQ_STAT after readData");
-    clearIRQStatus(TX_IRQ_STAT | IDLE_IRQ_STAT);
+    clearIRQStatus(TX_IRQ_STAT | IDLE_IRQ_STAT | GENERAL_ERROR_IRQ_STAT);
     return EC_NO_CARD;
   }
 
-  uint8_t responseFlags = (*resultPtr)[0];
   if (responseFlags & (1<<0)) { // error flag
-    uint8_t errorCode = (*resultPtr)[1];
-    
     PN5180DEBUG("ERROR code=");
     PN5180DEBUG(formatHex(errorCode));
     PN5180DEBUG(" - ");
@@ -807,7 +906,7 @@ ISO15693ErrorCode PN5180ISO15693::issueISO15693Command(const uint8_t *cmd, uint8
   }
 #endif
 
-  clearIRQStatus(RX_SOF_DET_IRQ_STAT | IDLE_IRQ_STAT | TX_IRQ_STAT | RX_IRQ_STAT);
+  clearIRQStatus(RX_SOF_DET_IRQ_STAT | IDLE_IRQ_STAT | TX_IRQ_STAT | RX_IRQ_STAT | GENERAL_ERROR_IRQ_STAT);
   return ISO15693_EC_OK;
 }
 
@@ -824,10 +923,10 @@ bool PN5180ISO15693::setupRF() {
   }
   else return false;
 
-  writeRegisterWithAndMask(SYSTEM_CONFIG, 0xfffffff8);  // Idle/StopCom Command
-  writeRegisterWithOrMask(SYSTEM_CONFIG, 0x00000003);   // Transceive Command
-
-  return true;
+  PN5180CommandQueue queue;
+  queue.writeRegisterWithAndMask(SYSTEM_CONFIG, 0xfffffff8);  // Idle/StopCom Command
+  queue.writeRegisterWithOrMask(SYSTEM_CONFIG, 0x00000003);   // Transceive Command
+  return execute(queue);
 }
 
 const char *PN5180ISO15693::strerror(ISO15693ErrorCode code) {
@@ -838,6 +937,7 @@ const char *PN5180ISO15693::strerror(ISO15693ErrorCode code) {
   switch (code) {
     case EC_NO_CARD: return ("No card detected!");
     case ISO15693_EC_OK: return ("OK!");
+    case EC_INVENTORY_INCOMPLETE: return ("Inventory incomplete!");
     case ISO15693_EC_NOT_SUPPORTED: return ("Command is not supported!");
     case ISO15693_EC_NOT_RECOGNIZED: return ("Command is not recognized!");
     case ISO15693_EC_OPTION_NOT_SUPPORTED: return ("Option is not supported!");
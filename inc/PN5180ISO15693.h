@@ -22,6 +22,7 @@
 #include "PN5180.h"
 
 enum ISO15693ErrorCode {
+  EC_INVENTORY_INCOMPLETE = -2,
   EC_NO_CARD = -1,
   ISO15693_EC_OK = 0,
   ISO15693_EC_NOT_SUPPORTED = 0x01,
@@ -36,6 +37,31 @@ enum ISO15693ErrorCode {
   ISO15693_EC_CUSTOM_CMD_ERROR = 0xA0
 };
 
+/*
+ * Pending collision masks of getInventoryMultiple(), fixed size ring buffer
+ */
+#ifndef ISO15693_INVENTORY_QUEUE_SIZE
+#define ISO15693_INVENTORY_QUEUE_SIZE (16)
+#endif
+
+struct ISO15693InventoryMask {
+  uint64_t value;   // UID bits, LSB first
+  uint8_t length;   // number of valid bits, multiple of 4
+};
+
+class ISO15693MaskQueue {
+public:
+  bool push(uint64_t value, uint8_t length);
+  bool pop(ISO15693InventoryMask &mask);
+  uint8_t size() const { return count; }
+  uint16_t dropped = 0;  // masks lost on a full queue
+
+private:
+  ISO15693InventoryMask masks[ISO15693_INVENTORY_QUEUE_SIZE];
+  uint8_t head = 0;
+  uint8_t count = 0;
+};
+
 class PN5180ISO15693 : public PN5180 {
 
 public:
@@ -43,10 +69,13 @@ public:
   
 private:
   ISO15693ErrorCode issueISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint8_t **resultPtr);
-  ISO15693ErrorCode inventoryPoll(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, uint8_t *numCol, uint16_t *collision);
+  ISO15693ErrorCode issueISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint8_t *result, uint16_t resultLen);
+  ISO15693ErrorCode transceiveISO15693Command(const uint8_t *cmd, uint8_t cmdLen, uint16_t *len);
+  ISO15693ErrorCode checkISO15693Response(uint8_t responseFlags, uint8_t errorCode);
+  ISO15693ErrorCode inventoryPoll(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, const ISO15693InventoryMask &mask, ISO15693MaskQueue &pending);
 public:
   ISO15693ErrorCode getInventory(uint8_t *uid);
-  ISO15693ErrorCode getInventoryMultiple(uint8_t *uid, uint8_t maxTags, uint8_t *numCard);
+  ISO15693ErrorCode getInventoryMultiple(uint8_t *uid, uint8_t maxTags, uint8_t *numCard, uint16_t maxMillis = 0);
 
   ISO15693ErrorCode readSingleBlock(const uint8_t *uid, uint8_t blockNo, uint8_t *blockData, uint8_t blockSize);
   ISO15693ErrorCode writeSingleBlock(const uint8_t *uid, uint8_t blockNo, const uint8_t *blockData, uint8_t blockSize);
@@ -8,6 +8,7 @@
 constexpr uint8_t PN5180_NSS_PIN = 16;    // SPI Chip Select for PN5180
 constexpr uint8_t PN5180_BUSY_PIN = 5;    // Busy pin for PN5180
 constexpr uint8_t PN5180_RST_PIN = 17;    // Reset pin for PN5180
+constexpr uint8_t PN5180_IRQ_PIN = 26;    // IRQ pin for PN5180 (LPCD wake-up)
 
 // ========== E-PAPER DISPLAY PINOUT ==========
 constexpr uint8_t EPD_CS_PIN = 15;        // Chip Select for ePaper display
@@ -18,25 +19,111 @@ constexpr uint8_t EPD_BUSY_PIN = 13;      // Busy pin for ePaper
 // ========== BUTTON CONFIGURATION ==========
 constexpr uint8_t MODE_BUTTON_PIN = 14;   // Button 1: Mode switch (NFC/WiFi)
 constexpr uint8_t SELECT_BUTTON_PIN = 27; // Button 2: Menu selection
+constexpr uint32_t BUTTON_DEBOUNCE_US = 20000;       // Level must be stable this long after the last edge
+constexpr uint32_t BUTTON_LONG_PRESS_MS = 1000;      // Mode button hold time for a long press
+constexpr uint32_t BUTTON_REPEAT_DELAY_MS = 500;     // Select button hold time before the first repeat
+constexpr uint32_t BUTTON_REPEAT_INTERVAL_MS = 200;  // Select button repeat interval while held
+constexpr uint8_t BUTTON_EVENT_QUEUE_LENGTH = 8;     // Pending button events for the UI
+
+// ========== LOW POWER CONFIGURATION ==========
+constexpr uint32_t NFC_IDLE_TIMEOUT_MS = 5000;       // No card or button activity before entering LPCD idle
+constexpr uint16_t LPCD_WAKEUP_INTERVAL_MS = 100;    // PN5180 field check interval while in LPCD
+
+// ========== NFC READER PROFILE ==========
+constexpr uint8_t NFC_REQUEST_KIND = 0;           // Card activation with 0 = REQA, 1 = WUPA
+constexpr uint8_t NFC_MAX_UID_LENGTH = 7;         // Longest accepted UID (4 or 7)
+static_assert(NFC_MAX_UID_LENGTH == 4 || NFC_MAX_UID_LENGTH == 7,
+              "activateTypeA() reads single and double size UIDs only");
+
+// ========== OFFLINE ALLOW-LIST CONFIGURATION ==========
+constexpr const char *ALLOWLIST_PATH = "/allowlist.bin";  // Sorted access records on LittleFS
+constexpr uint8_t ALLOWLIST_KEY_SIZE = 11;        // UID length byte + UID padded to 10 bytes
+constexpr uint8_t ALLOWLIST_RECORD_SIZE = 12;     // Key + decision byte (1 = allow, 0 = deny)
+
+// ========== ADAPTIVE POLLING CONFIGURATION ==========
+constexpr uint16_t NFC_POLL_FAST_MS = 30;            // Poll interval right after a card event or button press
+constexpr uint16_t NFC_POLL_SLOW_MS = 300;           // Longest poll interval before LPCD idle
+constexpr uint32_t NFC_POLL_FAST_PERIOD_MS = 1000;   // Fast polling time after activity
+constexpr uint8_t NFC_POLL_BACKOFF_PERCENT = 50;     // Interval increase per empty poll after the fast period
+constexpr uint16_t NFC_PRESENCE_INTERVAL_MS = 200;   // Presence check interval while a card is held
+
+// ========== TASK CONFIGURATION ==========
+constexpr uint8_t NFC_TASK_CORE = 0;              // NFC polling core (UI runs in loop() on core 1)
+constexpr uint32_t NFC_TASK_STACK_SIZE = 4096;    // NFC task stack (bytes)
+constexpr uint8_t NFC_TASK_PRIORITY = 2;          // Above the Arduino loop task
+constexpr uint8_t NFC_EVENT_QUEUE_LENGTH = 8;     // Pending card events for the UI
+constexpr uint16_t UI_POLL_INTERVAL_MS = 20;      // WiFi service interval while waiting for events
+constexpr uint32_t NFC_STATS_INTERVAL_MS = 60000; // PN5180 statistics print interval (0 = off)
+constexpr uint8_t NFC_REMOVAL_DEBOUNCE_POLLS = 2; // Failed polls before a card counts as removed
+constexpr uint8_t NFC_RF_CYCLE_FAILURES = 2;      // Reader failures before the RF field is cycled
+constexpr uint8_t NFC_HARD_RESET_FAILURES = 4;    // Reader failures before the PN5180 is reset
+constexpr uint8_t DISPLAY_TASK_CORE = 1;          // ePaper refresh core (shared with loop())
+constexpr uint32_t DISPLAY_TASK_STACK_SIZE = 4096; // Display task stack (bytes)
+constexpr uint8_t DISPLAY_TASK_PRIORITY = 1;      // Same as the Arduino loop task
+constexpr uint16_t EPD_BUSY_POLL_MS = 50;         // Max wait between BUSY checks (missed edge)
+
+// ========== DISPLAY LAYOUT CONFIGURATION ==========
+constexpr int16_t HEADER_HEIGHT = 50;             // Red header bar height
+constexpr int16_t MENU_START_Y = 70;              // Baseline of the first menu row
+constexpr int16_t MENU_LINE_HEIGHT = 30;          // WiFi main menu row pitch (12pt font)
+constexpr int16_t LIST_LINE_HEIGHT = 25;          // Network list / manual field row pitch (9pt font)
+constexpr int16_t WIDGET_ARROW_OFFSET = 15;       // Selection arrow distance left of a list item
+constexpr int16_t WIDGET_CENTERED = -1;           // Label x position to center horizontally
+constexpr uint8_t MAX_WIDGETS = 8;                // Widgets per screen
+constexpr uint8_t WIDGET_TEXT_LENGTH = 32;        // Widget text buffer (including terminator)
+constexpr uint8_t UID_TEXT_LENGTH = 30;           // "XX " per byte of a 10 byte UID (including terminator)
 
 // ========== WIFI CONFIGURATION ==========
 const char* WIFI_SSID = "Me Select IT";   // Default WiFi SSID
+const char* WIFI_PASSWORD = "";           // Password of WIFI_SSID (Manual Connect)
+constexpr uint8_t WIFI_SCAN_CHANNELS = 13;          // Channels scanned one by one
+constexpr uint16_t WIFI_SCAN_MS_PER_CHANNEL = 120;  // Active scan time per channel
+constexpr uint32_t WIFI_SCAN_CACHE_MS = 30000;      // Scan result age before re-entering rescans
+constexpr uint32_t WIFI_CONNECT_TIMEOUT_MS = 15000; // Menu connect timeout
+constexpr uint8_t WIFI_LIST_ROWS = 4;               // Network rows on the scan screen
+
+// ========== EVENT UPLINK CONFIGURATION ==========
+const char* UPLINK_URL = "http://192.168.1.10:8080/nfc/events";  // HTTP endpoint for event batches (JSON POST)
+const char* UPLINK_READER_ID = "nfc-display-1";                  // Reader id sent with every batch
+const char* UPLINK_NTP_SERVER = "pool.ntp.org";                  // Wall clock for the event timestamps
+constexpr const char *UPLINK_SPILL_PATH = "/events.bin";  // LittleFS overflow file (raw UplinkEvent records)
+constexpr uint16_t UPLINK_RING_SIZE = 64;          // Events buffered in RAM
+constexpr uint16_t UPLINK_SPILL_THRESHOLD = 48;    // Ring fill that moves events to LittleFS
+constexpr uint32_t UPLINK_SPILL_MAX_EVENTS = 4096; // Spill file limit, newer events are dropped
+constexpr uint8_t UPLINK_BATCH_SIZE = 16;          // Events per HTTP request
+constexpr uint32_t UPLINK_MAX_DELAY_MS = 60000;    // Oldest event age that triggers an upload
+constexpr uint32_t UPLINK_RETRY_MS = 120000;       // Wait after a failed connect or upload
+constexpr uint32_t UPLINK_CONNECT_TIMEOUT_MS = 10000; // WiFi association timeout
+constexpr uint16_t UPLINK_HTTP_TIMEOUT_MS = 5000;  // HTTP response timeout
+constexpr uint16_t UPLINK_CHECK_INTERVAL_MS = 1000; // Uplink task wake-up interval
+constexpr uint16_t UPLINK_BODY_SIZE = 2560;        // JSON body buffer for one batch
+constexpr uint8_t UPLINK_TASK_CORE = 1;            // Network upload core, away from the NFC task
+constexpr uint32_t UPLINK_TASK_STACK_SIZE = 8192;  // HTTPClient needs the larger stack (bytes)
+constexpr uint8_t UPLINK_TASK_PRIORITY = 0;        // Below the UI, uploads are never urgent
 
 // ========== SYSTEM INCLUDES ==========
 #include <PN5180.h>
 #include <PN5180ISO14443.h>
-#include <PN5180ISO15693.h>
 #include <SPI.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <HTTPClient.h>
+#include <time.h>
 
 // ========== E-PAPER DISPLAY LIBRARIES ==========
-#include <GxEPD2_BW.h>
 #include <GxEPD2_3C.h>
-#include <GxEPD2_4C.h>
-#include <GxEPD2_7C.h>
 #include <Fonts/FreeMonoBold9pt7b.h>
 #include <Fonts/FreeMonoBold18pt7b.h>
 #include <Fonts/FreeMonoBold12pt7b.h>
-#include <Fonts/FreeMonoBold24pt7b.h>
 
 // ========== HARDWARE OBJECT INSTANTIATION ==========
 // ePaper Display object (3-color, 2.66-inch)
@@ -46,6 +133,19 @@ GxEPD2_3C<GxEPD2_266c, GxEPD2_266c::HEIGHT> display(
                 /*RST=*/ EPD_RST_PIN, 
                 /*BUSY=*/ EPD_BUSY_PIN));
 
+/**
+ * @brief Text measurement surface with the landscape display size
+ * 
+ * Widgets are measured in the UI task while the display task draws,
+ * so font state must not be shared with the display object
+ */
+class TextMeasure : public Adafruit_GFX {
+public:
+    TextMeasure(int16_t width, int16_t height) : Adafruit_GFX(width, height) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {}
+};
+TextMeasure textMeasure(GxEPD2_266c::HEIGHT, GxEPD2_266c::WIDTH); // matches setRotation(1)
+
 // NFC Reader object (ISO14443 protocol)
 PN5180ISO14443 nfc(PN5180_NSS_PIN, PN5180_BUSY_PIN, PN5180_RST_PIN);
 
@@ -74,6 +174,155 @@ enum WifiSubMode {
     WIFI_SUB_MANUAL = 2
 };
 
+/**
+ * @brief Retained display widget types
+ * 
+ * WIDGET_HEADER: Red header bar with centered text
+ * WIDGET_LABEL: Single line of text
+ * WIDGET_LIST_ITEM: Menu entry, red with arrow when selected
+ * WIDGET_FIELD: "label: value" input field, blue value when active
+ * WIDGET_UID: Large centered card UID
+ */
+enum WidgetType {
+    WIDGET_HEADER = 0,
+    WIDGET_LABEL = 1,
+    WIDGET_LIST_ITEM = 2,
+    WIDGET_FIELD = 3,
+    WIDGET_UID = 4
+};
+
+struct Widget {
+    WidgetType type;
+    int16_t x, y;                      // Text cursor (baseline)
+    const GFXfont *font;
+    uint16_t color;
+    bool selected;
+    char text[WIDGET_TEXT_LENGTH];
+    char value[WIDGET_TEXT_LENGTH];    // Field value (WIDGET_FIELD only)
+    int16_t boundsX, boundsY;          // Screen area covered by the widget
+    uint16_t boundsW, boundsH;
+};
+
+/**
+ * @brief Card events posted by the NFC task to the UI
+ * 
+ * NFC_EVENT_CARD_ARRIVED: New card (or different UID) in the field
+ * NFC_EVENT_CARD_REMOVED: Card left the field
+ */
+enum NfcEventType {
+    NFC_EVENT_CARD_ARRIVED = 0,
+    NFC_EVENT_CARD_REMOVED = 1
+};
+
+/**
+ * @brief Offline access decision for a card UID
+ * 
+ * ACCESS_NO_LIST: No allow-list on LittleFS, nothing to decide
+ * ACCESS_UNKNOWN: UID not in the list
+ */
+enum AccessDecision {
+    ACCESS_NO_LIST = 0,
+    ACCESS_UNKNOWN = 1,
+    ACCESS_ALLOWED = 2,
+    ACCESS_DENIED = 3
+};
+
+struct NfcEvent {
+    NfcEventType type;
+    uint8_t uid[10];
+    uint8_t uidLength;
+    PN5180CardType cardType;
+    AccessDecision access;
+};
+
+/**
+ * @brief Button events posted by the button driver to the UI
+ * 
+ * BUTTON_EVENT_PRESS: Mode released before BUTTON_LONG_PRESS_MS, Select pressed
+ * BUTTON_EVENT_LONG_PRESS: Mode held for BUTTON_LONG_PRESS_MS
+ * BUTTON_EVENT_REPEAT: Select still held, every BUTTON_REPEAT_INTERVAL_MS
+ */
+enum ButtonEventType {
+    BUTTON_EVENT_PRESS = 0,
+    BUTTON_EVENT_LONG_PRESS = 1,
+    BUTTON_EVENT_REPEAT = 2
+};
+
+enum ButtonId {
+    BUTTON_MODE = 0,
+    BUTTON_SELECT = 1,
+    BUTTON_COUNT = 2
+};
+
+struct ButtonEvent {
+    ButtonId button;
+    ButtonEventType type;
+};
+
+/**
+ * @brief Button driver state, the timers run in the esp_timer task
+ */
+struct ButtonState {
+    uint8_t pin;
+    bool repeat;                      // true: PRESS when pressed + REPEAT, false: PRESS when released or LONG_PRESS
+    volatile int64_t edgeTime;        // ISR: esp_timer_get_time() of the last edge
+    volatile bool busy;               // Pressed or debounce pending, NFC task must not light sleep
+    bool pressed;                     // Debounced level
+    bool holdFired;                   // LONG_PRESS or REPEAT sent for this press
+    int64_t pressTime;                // Edge that started the press
+    esp_timer_handle_t debounceTimer;
+    esp_timer_handle_t holdTimer;
+};
+
+/**
+ * @brief One network of a WiFi scan
+ */
+struct WifiNetwork {
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t bssid[6];
+    bool open;                         // No password needed
+};
+
+/**
+ * @brief Credentials of a connection, stored in Preferences
+ * 
+ * BSSID and channel let a reconnect skip the full channel scan.
+ */
+struct WifiCredentials {
+    char ssid[33];
+    char password[65];
+    uint8_t bssid[6];
+    uint8_t channel;                   // 0 = unknown, full scan
+};
+
+/**
+ * @brief Menu connection states
+ */
+enum WifiConnectState {
+    WIFI_STATE_IDLE = 0,
+    WIFI_STATE_CONNECTING = 1,
+    WIFI_STATE_CONNECTED = 2,
+    WIFI_STATE_FAILED = 3
+};
+
+/**
+ * @brief Card event record for the uplink
+ * 
+ * Same layout in the RAM ring and in the LittleFS spill file.
+ */
+struct UplinkEvent {
+    uint32_t boot;                     // Boot counter (Preferences), sequence restarts with each boot
+    uint32_t sequence;                 // Event counter since boot
+    uint32_t uptimeMs;                 // millis() of the event
+    uint32_t epochSeconds;             // Wall clock time, 0 if not synchronized
+    uint32_t latencyUs;                // Card read time of an arrival, 0 for removal
+    uint8_t uid[10];
+    uint8_t uidLength;
+    uint8_t type;                      // NfcEventType
+};
+
 // ========== SYSTEM STATE VARIABLES ==========
 // Mode Management
 volatile SystemMode currentMode = MODE_NFC;
@@ -83,93 +332,315 @@ WifiSubMode lastWifiSubMode = WIFI_SUB_NONE;
 
 // Display State
 bool displayInitialized = false;
+bool displayColdBoot = true;          // Power-on reset: panel needs the initial clear
 bool displayUpdateRequired = true;
 bool systemReady = false;
 
-// ========== BUTTON HANDLING VARIABLES ==========
-// Mode Button (Button 1) State
-volatile bool modeButtonPressed = false;
-volatile bool modeButtonLongPressed = false;
-volatile unsigned long modeButtonPressTime = 0;
-const unsigned long LONG_PRESS_DURATION = 1000; // 1 second for long press
+// Retained Frames (last rendered vs. being built)
+Widget shownWidgets[MAX_WIDGETS];
+uint8_t shownWidgetCount = 0;
+Widget frameWidgets[MAX_WIDGETS];
+uint8_t frameWidgetCount = 0;
+bool frameShown = false;              // shownWidgets is on the panel
+
+// Display Task Communication
+Widget pendingWidgets[MAX_WIDGETS];   // Latest committed frame, not rendered yet
+uint8_t pendingWidgetCount = 0;
+volatile bool framePending = false;
+Widget renderWidgets[MAX_WIDGETS];    // Frame being rendered by the display task
+uint8_t renderWidgetCount = 0;
+volatile bool displayRefreshActive = false;
+portMUX_TYPE displayFrameMux = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t displayTaskHandle = NULL;
+SemaphoreHandle_t epdBusySemaphore = NULL;  // Given on EPD BUSY falling edge
+SemaphoreHandle_t spiBusMutex = NULL;       // Shared SPI bus: PN5180 and ePaper (SCK/MOSI GPIO18/23)
+bool displayHoldsBus = false;               // Display task: bus taken for the panel RAM write
+
+// Task Communication
+QueueHandle_t nfcEventQueue = NULL;  // NfcEvent from NFC task to UI
+volatile bool uiIdle = false;        // UI has nothing pending, NFC task may sleep
 
-// Select Button (Button 2) State
-volatile bool selectButtonPressed = false;
-volatile unsigned long selectButtonPressTime = 0;
-volatile unsigned long lastSelectDebounceTime = 0;
-const unsigned long SELECT_DEBOUNCE_TIME = 200; // 200ms debounce
+// ========== BUTTON DRIVER STATE ==========
+ButtonState buttons[BUTTON_COUNT] = {
+    {MODE_BUTTON_PIN, false},
+    {SELECT_BUTTON_PIN, true}
+};
+QueueHandle_t buttonEventQueue = NULL;  // ButtonEvent from the button timers to the UI
+TaskHandle_t uiTaskHandle = NULL;       // loop() task, woken by button and NFC events
+uint32_t buttonEventsDropped = 0;       // Events lost to a full queue
 
 // ========== MENU NAVIGATION VARIABLES ==========
 int wifiMenuSelection = 0;    // 0: Scan WiFi, 1: Manual Connect
 int scanWifiSelection = 0;    // Selected WiFi network index
 
 // ========== NFC READING STATE ==========
-String lastUID = "";
-bool cardDetected = false;
-uint8_t lastValidUID[10] = {0};
-int lastValidLength = 0;
-
-// ========== WIFI DEMO DATA ==========
-String wifiSSID = "Me Select IT";
-String wifiIP = "192.168.1.100";
-String manualSSID = "";
-String manualPassword = "";
+bool cardDetected = false;           // UI: card shown on the NFC screen
+uint8_t cardUID[10] = {0};           // UI: UID of the shown card
+uint8_t cardUIDLength = 0;
+PN5180CardType cardType = PN5180_CARD_UNKNOWN;  // UI: type of the shown card
+AccessDecision cardAccess = ACCESS_NO_LIST;     // UI: allow-list decision of the shown card
+uint8_t lastValidUID[10] = {0};      // NFC task: UID of the card in the field
+uint8_t lastValidLength = 0;         // NFC task: 0 = no card
+PN5180CardType nfcCardType = PN5180_CARD_UNKNOWN;  // NFC task: type of the last read card
+
+// ========== OFFLINE ALLOW-LIST STATE ==========
+File allowListFile;                  // NFC task: open for the lookups, stays in flash
+uint32_t allowListCount = 0;         // Records in allowListFile, 0 = no list
+
+// ========== EVENT UPLINK STATE ==========
+UplinkEvent uplinkRing[UPLINK_RING_SIZE];  // Oldest event at uplinkTail
+uint16_t uplinkTail = 0;
+uint16_t uplinkCount = 0;
+uint32_t uplinkBoot = 0;                   // Boot counter, set before the NFC task starts
+uint32_t uplinkSequence = 0;
+uint32_t uplinkDropped = 0;                // Events lost to a full ring or spill file
+portMUX_TYPE uplinkMux = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t uplinkTaskHandle = NULL;
+uint32_t uplinkSpillCount = 0;             // Uplink task: records in the spill file
+uint32_t uplinkSpillSent = 0;              // Uplink task: records already uploaded
+volatile bool uplinkBusy = false;          // Radio in use, NFC task must not light sleep
+uint32_t nfcReadLatencyUs = 0;             // NFC task: duration of the last card read
+
+// ========== NFC POLL SCHEDULER ==========
+TaskHandle_t nfcTaskHandle = NULL;
+uint8_t nfcFailures = 0;                      // Consecutive reader failures (NFC task)
+volatile uint32_t nfcActivityTime = 0;        // millis() of the last card event or button press
+uint16_t nfcPollInterval = NFC_POLL_FAST_MS;  // Current poll interval (NFC task)
+
+// ========== NFC LOW POWER STATE ==========
+bool lpcdReady = false;        // LPCD EEPROM configuration done
+PN5180LPCDConfig lpcdConfig;   // LPCD settings, threshold set by calibration
+uint8_t nfcIrqWakeLevel = 1;   // Active level of the PN5180 IRQ pin
+
+// ========== WIFI STATE ==========
+String wifiSSID = "";         // Network connected from the menu
+String wifiIP = "";
+String manualSSID = WIFI_SSID;
+String manualPassword = WIFI_PASSWORD;
 int manualInputField = 0; // 0: SSID field, 1: Password field
 
-// ========== DEMO WIFI NETWORKS ==========
-const int MAX_WIFI_NETWORKS = 5;
-String wifiNetworks[MAX_WIFI_NETWORKS] = {
-    "Me Select S",
-    "Me Select IT",
-    "Qinef",
-    "Free_WiFi",
-    ""
-};
+// ========== WIFI SCAN RESULTS ==========
+const int MAX_WIFI_NETWORKS = 8;
+WifiNetwork wifiNetworks[MAX_WIFI_NETWORKS];  // Last scan, strongest first
+uint8_t wifiNetworkCount = 0;
+bool wifiScanValid = false;                   // wifiNetworks holds a finished scan
+unsigned long wifiScanTime = 0;               // millis() when the last scan finished
+bool wifiScanRequested = false;               // Scan starts once the uplink leaves the radio
+uint8_t wifiScanChannel = 0;                  // Channel being scanned, 0 = no scan
+
+// ========== WIFI CONNECTION STATE ==========
+WifiConnectState wifiConnectState = WIFI_STATE_IDLE;
+unsigned long wifiConnectStart = 0;           // 0 = begin() still pending
+WifiCredentials wifiPending;                  // UI: network being connected
+WifiCredentials storedWifi;                   // Last successful connection (Preferences)
+portMUX_TYPE storedWifiMux = portMUX_INITIALIZER_UNLOCKED;
 
-// ========== INTERRUPT SERVICE ROUTINES ==========
+// ========== BUTTON DRIVER ==========
 /**
- * @brief Interrupt handler for Mode button (GPIO14)
+ * @brief Posts a button event and wakes the UI
  * 
- * Handles both short press and long press detection
- * Triggered on both rising and falling edges
+ * Runs in the esp_timer task, never blocks on a full queue.
  */
-void IRAM_ATTR handleModeButtonInterrupt() {
-    unsigned long currentTime = millis();
-    
-    if (digitalRead(MODE_BUTTON_PIN) == LOW) {
-        // Button pressed down - record start time
-        modeButtonPressTime = currentTime;
-    } else {
-        // Button released - calculate press duration
-        unsigned long pressDuration = currentTime - modeButtonPressTime;
-        
-        // Debounce check (minimum 50ms press)
-        if (pressDuration > 50) {
-            if (pressDuration >= LONG_PRESS_DURATION) {
-                modeButtonLongPressed = true;
-            } else {
-                modeButtonPressed = true;
+void postButtonEvent(ButtonId id, ButtonEventType type) {
+    ButtonEvent event = {id, type};
+    if (xQueueSend(buttonEventQueue, &event, 0) != pdTRUE) {
+        buttonEventsDropped++;
+        return;
+    }
+    if (uiTaskHandle != NULL) {
+        xTaskNotifyGive(uiTaskHandle);
+    }
+}
+
+/**
+ * @brief GPIO interrupt of both buttons, any edge
+ * 
+ * Only timestamps the edge and restarts the debounce timer, the level
+ * is sampled once it has been stable for BUTTON_DEBOUNCE_US.
+ */
+void IRAM_ATTR handleButtonInterrupt(void *arg) {
+    ButtonState *button = (ButtonState *)arg;
+    button->edgeTime = esp_timer_get_time();
+    button->busy = true;
+    esp_timer_stop(button->debounceTimer);
+    esp_timer_start_once(button->debounceTimer, BUTTON_DEBOUNCE_US);
+}
+
+/**
+ * @brief Debounce timer, takes over the settled button level
+ * 
+ * Bounces shorter than BUTTON_DEBOUNCE_US end on the old level and
+ * produce no event. Hold times count from the first edge.
+ */
+void handleButtonDebounce(void *arg) {
+    ButtonState *button = (ButtonState *)arg;
+    ButtonId id = (ButtonId)(button - buttons);
+    bool pressed = (gpio_get_level((gpio_num_t)button->pin) == 0);
+    
+    if (pressed != button->pressed) {
+        button->pressed = pressed;
+        if (pressed) {
+            button->pressTime = button->edgeTime;
+            button->holdFired = false;
+            int64_t holdUs = 1000LL * (button->repeat ? BUTTON_REPEAT_DELAY_MS : BUTTON_LONG_PRESS_MS);
+            int64_t heldUs = esp_timer_get_time() - button->pressTime;
+            esp_timer_start_once(button->holdTimer, (heldUs < holdUs) ? (holdUs - heldUs) : 0);
+            if (button->repeat) {
+                postButtonEvent(id, BUTTON_EVENT_PRESS);
+            }
+        } else {
+            esp_timer_stop(button->holdTimer);
+            if (!button->repeat && !button->holdFired) {
+                postButtonEvent(id, BUTTON_EVENT_PRESS);
             }
         }
     }
+    button->busy = pressed;
+}
+
+/**
+ * @brief Hold timer, long press or auto repeat while the button is held
+ */
+void handleButtonHold(void *arg) {
+    ButtonState *button = (ButtonState *)arg;
+    ButtonId id = (ButtonId)(button - buttons);
+    if (!button->pressed) return;
+    
+    button->holdFired = true;
+    if (button->repeat) {
+        postButtonEvent(id, BUTTON_EVENT_REPEAT);
+        esp_timer_start_once(button->holdTimer, 1000ULL * BUTTON_REPEAT_INTERVAL_MS);
+    } else {
+        postButtonEvent(id, BUTTON_EVENT_LONG_PRESS);
+    }
 }
 
 /**
- * @brief Interrupt handler for Select button (GPIO27)
+ * @brief Sets up the button pins, timers, interrupts and event queue
  * 
- * Handles button press with debouncing
- * Triggered on falling edge only
+ * A button held during boot produces no event until it is released.
  */
-void IRAM_ATTR handleSelectButtonInterrupt() {
-    unsigned long currentTime = millis();
+void beginButtons() {
+    buttonEventQueue = xQueueCreate(BUTTON_EVENT_QUEUE_LENGTH, sizeof(ButtonEvent));
     
-    // Debounce logic
-    if (currentTime - lastSelectDebounceTime > SELECT_DEBOUNCE_TIME) {
-        if (digitalRead(SELECT_BUTTON_PIN) == LOW) {
-            selectButtonPressed = true;
-            selectButtonPressTime = currentTime;
-        }
-        lastSelectDebounceTime = currentTime;
+    // Shared with attachInterrupt(), which accepts an installed service
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        Serial.println("GPIO ISR service failed, buttons disabled");
+        return;
+    }
+    
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        ButtonState &button = buttons[i];
+        pinMode(button.pin, INPUT_PULLUP);
+        
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.arg = &button;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.callback = handleButtonDebounce;
+        timerArgs.name = "buttonDebounce";
+        esp_timer_create(&timerArgs, &button.debounceTimer);
+        timerArgs.callback = handleButtonHold;
+        timerArgs.name = "buttonHold";
+        esp_timer_create(&timerArgs, &button.holdTimer);
+        
+        button.pressed = (digitalRead(button.pin) == LOW);
+        button.holdFired = button.pressed;
+        gpio_set_intr_type((gpio_num_t)button.pin, GPIO_INTR_ANYEDGE);
+        gpio_isr_handler_add((gpio_num_t)button.pin, handleButtonInterrupt, &button);
+    }
+}
+
+/**
+ * @brief Re-arms the button interrupts after light sleep
+ * 
+ * gpio_wakeup_enable() leaves the pins on level interrupts and edges
+ * during sleep are not seen, so both buttons are sampled again.
+ */
+void resyncButtons() {
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        gpio_set_intr_type((gpio_num_t)buttons[i].pin, GPIO_INTR_ANYEDGE);
+        handleButtonInterrupt(&buttons[i]);
+    }
+}
+
+/**
+ * @brief true if no button is held or settling
+ */
+bool buttonsIdle() {
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (buttons[i].busy) return false;
+    }
+    return true;
+}
+
+// ========== SPI BUS ARBITRATION ==========
+/**
+ * @brief PN5180 bus lock hook, taken around every reader SPI transaction
+ */
+void lockSpiBus(void *context) {
+    xSemaphoreTake(spiBusMutex, portMAX_DELAY);
+}
+
+/**
+ * @brief PN5180 bus unlock hook
+ */
+void unlockSpiBus(void *context) {
+    xSemaphoreGive(spiBusMutex);
+}
+
+/**
+ * @brief Takes the bus for the panel RAM write of one frame
+ * 
+ * Reader commands wait until the frame data is sent. The busy
+ * callback lends the bus to the readers while the panel is busy, a
+ * refresh never blocks them.
+ */
+void acquireDisplayBus() {
+    if (!displayHoldsBus) {
+        xSemaphoreTake(spiBusMutex, portMAX_DELAY);
+        displayHoldsBus = true;
+    }
+}
+
+/**
+ * @brief Gives the bus back after the panel RAM write
+ */
+void releaseDisplayBus() {
+    if (displayHoldsBus) {
+        displayHoldsBus = false;
+        xSemaphoreGive(spiBusMutex);
+    }
+}
+
+/**
+ * @brief Interrupt handler for ePaper BUSY (GPIO13) falling edge
+ * 
+ * Panel finished its refresh, wakes up the display task
+ */
+void IRAM_ATTR handleEpdBusyInterrupt() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(epdBusySemaphore, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief GxEPD2 busy callback, called while BUSY is active
+ * 
+ * Blocks the display task on the BUSY edge instead of polling with
+ * delay(1). GxEPD2 checks the pin again after every call, so a missed
+ * edge only costs EPD_BUSY_POLL_MS. The SPI bus is free while the
+ * panel is busy and taken again before GxEPD2 continues, so RAM
+ * writes after a busy wait (init, clear, next page) keep the lock.
+ */
+void epdBusyCallback(const void *parameter) {
+    bool heldBus = displayHoldsBus;
+    releaseDisplayBus();
+    xSemaphoreTake(epdBusySemaphore, pdMS_TO_TICKS(EPD_BUSY_POLL_MS));
+    if (heldBus) {
+        acquireDisplayBus();
     }
 }
 
@@ -179,11 +650,11 @@ void IRAM_ATTR handleSelectButtonInterrupt() {
  * 
  * @param text Header text to display
  * 
- * Creates a red header bar (50px height) with centered white text
+ * Creates a red header bar (HEADER_HEIGHT) with centered white text
  */
-void drawHeader(String text) {
+void drawHeader(const char *text) {
     // Draw red header background
-    display.fillRect(0, 0, display.width(), 50, GxEPD_RED);
+    display.fillRect(0, 0, display.width(), HEADER_HEIGHT, GxEPD_RED);
     
     // Configure text properties
     display.setTextColor(GxEPD_WHITE);
@@ -197,8 +668,8 @@ void drawHeader(String text) {
     // Center text horizontally
     uint16_t xPosition = (display.width() - textWidth) / 2 - textBoundsX;
     
-    // Center text vertically within 50px header
-    uint16_t yPosition = (50 - textHeight) / 2 - textBoundsY;
+    // Center text vertically within header
+    uint16_t yPosition = (HEADER_HEIGHT - textHeight) / 2 - textBoundsY;
     yPosition += 2; // Minor vertical adjustment
     
     // Draw centered text
@@ -206,34 +677,7 @@ void drawHeader(String text) {
     display.println(text);
 }
 
-/**
- * @brief Draws centered text at specified vertical position
- * 
- * @param text Text to display
- * @param yPos Vertical position for text
- * @param font Pointer to font to use
- * @param color Text color
- * 
- * Centers text horizontally on the display
- */
-void drawCenteredText(String text, uint16_t yPos, const GFXfont* font, uint16_t color) {
-    display.setFont(font);
-    display.setTextColor(color);
-    
-    // Calculate text bounds for centering
-    int16_t textBoundsX, textBoundsY;
-    uint16_t textWidth, textHeight;
-    display.getTextBounds(text, 0, 0, &textBoundsX, &textBoundsY, &textWidth, &textHeight);
-    
-    // Calculate centered X position
-    uint16_t xPosition = (display.width() - textWidth) / 2 - textBoundsX;
-    
-    // Draw centered text
-    display.setCursor(xPosition, yPos);
-    display.println(text);
-}
-
-// ========== E-PAPER DISPLAY SCREENS ==========
+// ========== DISPLAY WIDGET LAYER ==========
 /**
  * @brief Initializes the ePaper display if not already initialized
  * 
@@ -242,626 +686,1806 @@ void drawCenteredText(String text, uint16_t yPos, const GFXfont* font, uint16_t
 void initDisplay() {
     if (!displayInitialized) {
         Serial.println("Initializing ePaper display...");
-        display.init(115200, true, 2, false);
+        display.init(115200, displayColdBoot, 2, false);
         display.setRotation(1); // 90-degree landscape rotation
-        display.clearScreen();
+        
+        // Wait for BUSY edges instead of polling (after init, pinMode resets the pin)
+        display.epd2.setBusyCallback(epdBusyCallback);
+        attachInterrupt(digitalPinToInterrupt(EPD_BUSY_PIN), 
+                        handleEpdBusyInterrupt, FALLING);
+        
+        // The first frame is a full refresh anyway, clear only after power-on
+        if (displayColdBoot) {
+            display.clearScreen();
+        }
         displayInitialized = true;
+        frameShown = false;
         Serial.println("ePaper display initialized!");
     }
 }
 
 /**
- * @brief Displays the NFC ready screen (no card detected)
+ * @brief Starts building a new frame
  * 
- * Shows NFC mode header with instructions
+ * Screens add their widgets in a fixed order, commitFrame() then diffs
+ * them slot by slot against the last rendered frame
  */
-void displayNoCardScreen() {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Draw NFC mode header
-    drawHeader("NFC MODE");
-    
-    // Define layout positions
-    const uint16_t LEFT_MARGIN = 20;
-    const uint16_t READY_Y_POSITION = 80;
-    const uint16_t STANDARD_Y_POSITION = 105;
-    const uint16_t INSTRUCTION_Y_POSITION = display.height() - 15;
-    
-    // Display centered status messages
-    drawCenteredText("Tap card to read", READY_Y_POSITION, &FreeMonoBold12pt7b, GxEPD_BLACK);
-    drawCenteredText("ISO14443A", STANDARD_Y_POSITION, &FreeMonoBold9pt7b, GxEPD_BLACK);
-    
-    // Display left-aligned instructions
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setTextColor(GxEPD_BLACK);
-    display.setCursor(LEFT_MARGIN, INSTRUCTION_Y_POSITION);
-    display.println("Press B1 to switch mode");
-    
-    display.display(true);
+void beginFrame() {
+    frameWidgetCount = 0;
 }
 
 /**
- * @brief Displays detected card UID
- * 
- * @param uid Card UID string to display
+ * @brief Reserves the next frame slot
  * 
- * Shows UID in large font with instructions
+ * @return Cleared widget, or NULL if the frame is full
  */
-void showUIDSmall(String uid) {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Draw UID header
-    drawHeader("Card UID");
-    
-    // Define layout positions
-    const uint16_t LEFT_MARGIN = 20;
-    const uint16_t INSTRUCTION_Y_POSITION = display.height() - 15;
-    
-    // Display centered UID
-    drawCenteredText(uid, display.height() / 2 + 10, &FreeMonoBold18pt7b, GxEPD_BLACK);
-    
-    // Display instructions
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setTextColor(GxEPD_BLACK);
-    display.setCursor(LEFT_MARGIN, INSTRUCTION_Y_POSITION);
-    display.println("Wait 10s to the next read");
-    
-    display.display(true);
+Widget *nextWidget(WidgetType type) {
+    if (frameWidgetCount >= MAX_WIDGETS) {
+        Serial.println("Display frame full, widget dropped");
+        return NULL;
+    }
+    Widget *widget = &frameWidgets[frameWidgetCount++];
+    memset(widget, 0, sizeof(Widget));
+    widget->type = type;
+    return widget;
 }
 
 /**
- * @brief Displays main WiFi mode menu
- * 
- * Shows two options: Scan WiFi and Manual Connect
- * Uses red highlight for selected option
+ * @brief Adds the bounds of text drawn in font at x, y to a widget
  */
-void displayWifiMainMenu() {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Draw WiFi mode header
-    drawHeader("WiFi MODE");
-    
-    // Define layout parameters
-    const uint16_t LEFT_MARGIN = 20;
-    const uint16_t START_Y_POSITION = 70;
-    const uint16_t LINE_HEIGHT = 30;
-    const uint16_t INSTRUCTION1_Y_POSITION = display.height() - 30;
-    const uint16_t INSTRUCTION2_Y_POSITION = display.height() - 15;
-    
-    // Display menu options
-    for (int optionIndex = 0; optionIndex < 2; optionIndex++) {
-        uint16_t yPosition = START_Y_POSITION + (optionIndex * LINE_HEIGHT);
-        
-        if (optionIndex == wifiMenuSelection) {
-            // Selected option: red with arrow
-            display.setCursor(LEFT_MARGIN - 15, yPosition);
-            display.setFont(&FreeMonoBold12pt7b);
-            display.setTextColor(GxEPD_RED);
-            display.print(">");
-            
-            display.setCursor(LEFT_MARGIN, yPosition);
-            if (optionIndex == 0) {
-                display.println("1. Scan WiFi");
-            } else {
-                display.println("2. Manual Connect");
-            }
-        } else {
-            // Unselected option: black without arrow
-            display.setCursor(LEFT_MARGIN, yPosition);
-            display.setFont(&FreeMonoBold12pt7b);
-            display.setTextColor(GxEPD_BLACK);
-            if (optionIndex == 0) {
-                display.println("1. Scan WiFi");
-            } else {
-                display.println("2. Manual Connect");
-            }
-        }
+void addTextBounds(Widget *widget, const char *text, int16_t x, int16_t y, const GFXfont *font) {
+    int16_t textBoundsX, textBoundsY;
+    uint16_t textWidth, textHeight;
+    textMeasure.setFont(font);
+    textMeasure.getTextBounds(text, x, y, &textBoundsX, &textBoundsY, &textWidth, &textHeight);
+    
+    if (widget->boundsW == 0 || widget->boundsH == 0) {
+        widget->boundsX = textBoundsX;
+        widget->boundsY = textBoundsY;
+        widget->boundsW = textWidth;
+        widget->boundsH = textHeight;
+        return;
     }
     
-    // Display centered instructions
-    display.setTextColor(GxEPD_BLACK);
-    display.setFont(&FreeMonoBold9pt7b);
-    
-    // Instruction line 1: "Press B2 to select"
-    String instruction1 = "Press B2 to select";
-    int16_t textBoundsX1, textBoundsY1;
-    uint16_t textWidth1, textHeight1;
-    display.getTextBounds(instruction1, 0, 0, &textBoundsX1, &textBoundsY1, &textWidth1, &textHeight1);
-    uint16_t xPosition1 = (display.width() - textWidth1) / 2 - textBoundsX1;
-    display.setCursor(xPosition1, INSTRUCTION1_Y_POSITION);
-    display.println(instruction1);
-    
-    // Instruction line 2: "Hold B1 to confirm"
-    String instruction2 = "Hold B1 to confirm";
-    int16_t textBoundsX2, textBoundsY2;
-    uint16_t textWidth2, textHeight2;
-    display.getTextBounds(instruction2, 0, 0, &textBoundsX2, &textBoundsY2, &textWidth2, &textHeight2);
-    uint16_t xPosition2 = (display.width() - textWidth2) / 2 - textBoundsX2;
-    display.setCursor(xPosition2, INSTRUCTION2_Y_POSITION);
-    display.println(instruction2);
-    
-    display.display(true);
+    int16_t right = max(widget->boundsX + widget->boundsW, textBoundsX + textWidth);
+    int16_t bottom = max(widget->boundsY + widget->boundsH, textBoundsY + textHeight);
+    widget->boundsX = min(widget->boundsX, textBoundsX);
+    widget->boundsY = min(widget->boundsY, textBoundsY);
+    widget->boundsW = right - widget->boundsX;
+    widget->boundsH = bottom - widget->boundsY;
 }
 
 /**
- * @brief Displays WiFi scanning screen
+ * @brief Returns the cursor x position that centers text on the display
+ */
+int16_t centeredTextX(const char *text, const GFXfont *font) {
+    int16_t textBoundsX, textBoundsY;
+    uint16_t textWidth, textHeight;
+    textMeasure.setFont(font);
+    textMeasure.getTextBounds(text, 0, 0, &textBoundsX, &textBoundsY, &textWidth, &textHeight);
+    return (display.width() - textWidth) / 2 - textBoundsX;
+}
+
+/**
+ * @brief Adds the red header bar
  * 
- * Shows list of available WiFi networks with selection indicator
+ * @param text Header text
  */
-void displayScanWifiScreen() {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Draw WiFi scan header
-    drawHeader("Scan WiFi");
-    
-    // Define layout parameters
-    const uint16_t LEFT_MARGIN = 20;
-    const uint16_t START_Y_POSITION = 70;
-    const uint16_t LINE_HEIGHT = 25;
-    
-    // Display WiFi network list
-    for (int networkIndex = 0; networkIndex < MAX_WIFI_NETWORKS; networkIndex++) {
-        uint16_t yPosition = START_Y_POSITION + (networkIndex * LINE_HEIGHT);
-        
-        if (networkIndex == scanWifiSelection) {
-            // Selected network: red with arrow
-            display.setCursor(LEFT_MARGIN - 15, yPosition);
-            display.setFont(&FreeMonoBold9pt7b);
-            display.setTextColor(GxEPD_RED);
-            display.print(">");
-            
-            display.setCursor(LEFT_MARGIN, yPosition);
-            display.print(networkIndex + 1);
-            display.print(". ");
-            display.println(wifiNetworks[networkIndex]);
-        } else {
-            // Unselected network: black without arrow
-            display.setCursor(LEFT_MARGIN, yPosition);
-            display.setFont(&FreeMonoBold9pt7b);
-            display.setTextColor(GxEPD_BLACK);
-            display.print(networkIndex + 1);
-            display.print(". ");
-            display.println(wifiNetworks[networkIndex]);
-        }
-    }
+void addHeader(const char *text) {
+    Widget *widget = nextWidget(WIDGET_HEADER);
+    if (widget == NULL) return;
     
-    display.display(true);
+    strncpy(widget->text, text, WIDGET_TEXT_LENGTH - 1);
+    widget->boundsW = display.width();
+    widget->boundsH = HEADER_HEIGHT;
 }
 
 /**
- * @brief Displays manual WiFi connection screen
+ * @brief Adds a line of text
  * 
- * Shows SSID and password fields with input indicators
+ * @param text Label text
+ * @param x Cursor x position, WIDGET_CENTERED to center horizontally
+ * @param y Baseline position
+ * @param font Font to use
+ * @param color Text color
  */
-void displayManualConnectScreen() {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Draw manual connect header
-    drawHeader("Manual Connect");
+void addLabel(const char *text, int16_t x, int16_t y, const GFXfont *font, uint16_t color) {
+    Widget *widget = nextWidget(WIDGET_LABEL);
+    if (widget == NULL) return;
+    
+    strncpy(widget->text, text, WIDGET_TEXT_LENGTH - 1);
+    widget->x = (x == WIDGET_CENTERED) ? centeredTextX(widget->text, font) : x;
+    widget->y = y;
+    widget->font = font;
+    widget->color = color;
+    addTextBounds(widget, widget->text, widget->x, widget->y, font);
+}
+
+/**
+ * @brief Adds a menu entry, selected entries are red with an arrow
+ * 
+ * @param text Entry text
+ * @param x Cursor x position, the arrow is drawn left of it
+ * @param y Baseline position
+ * @param font Font to use
+ * @param selected Entry is highlighted
+ */
+void addListItem(const char *text, int16_t x, int16_t y, const GFXfont *font, bool selected) {
+    Widget *widget = nextWidget(WIDGET_LIST_ITEM);
+    if (widget == NULL) return;
+    
+    strncpy(widget->text, text, WIDGET_TEXT_LENGTH - 1);
+    widget->x = x;
+    widget->y = y;
+    widget->font = font;
+    widget->color = selected ? GxEPD_RED : GxEPD_BLACK;
+    widget->selected = selected;
+    // Arrow area is part of the bounds, selection changes clear it
+    addTextBounds(widget, ">", x - WIDGET_ARROW_OFFSET, y, font);
+    addTextBounds(widget, widget->text, x, y, font);
+}
+
+/**
+ * @brief Adds a "label: value" input field
+ * 
+ * @param label Field label, always black
+ * @param value Field value, blue when active
+ * @param x Cursor x position, the arrow is drawn left of it
+ * @param y Baseline position
+ * @param active Field has the input focus
+ */
+void addField(const char *label, const char *value, int16_t x, int16_t y, bool active) {
+    Widget *widget = nextWidget(WIDGET_FIELD);
+    if (widget == NULL) return;
+    
+    strncpy(widget->text, label, WIDGET_TEXT_LENGTH - 1);
+    strncpy(widget->value, value, WIDGET_TEXT_LENGTH - 1);
+    widget->x = x;
+    widget->y = y;
+    widget->font = &FreeMonoBold9pt7b;
+    widget->color = active ? GxEPD_BLUE : GxEPD_BLACK;
+    widget->selected = active;
+    
+    char line[2 * WIDGET_TEXT_LENGTH];
+    snprintf(line, sizeof(line), "%s%s", widget->text, widget->value);
+    addTextBounds(widget, ">", x - WIDGET_ARROW_OFFSET, y, widget->font);
+    addTextBounds(widget, line, x, y, widget->font);
+}
+
+/**
+ * @brief Adds the large, centered card UID
+ * 
+ * @param uid UID hex string
+ * @param y Baseline position
+ */
+void addUIDField(const char *uid, int16_t y) {
+    Widget *widget = nextWidget(WIDGET_UID);
+    if (widget == NULL) return;
+    
+    strncpy(widget->text, uid, WIDGET_TEXT_LENGTH - 1);
+    widget->font = &FreeMonoBold18pt7b;
+    widget->x = centeredTextX(widget->text, widget->font);
+    widget->y = y;
+    widget->color = GxEPD_BLACK;
+    addTextBounds(widget, widget->text, widget->x, widget->y, widget->font);
+}
+
+/**
+ * @brief Compares two widgets including position and content
+ */
+bool widgetEquals(const Widget &a, const Widget &b) {
+    return a.type == b.type && a.x == b.x && a.y == b.y && 
+           a.font == b.font && a.color == b.color && a.selected == b.selected &&
+           a.boundsX == b.boundsX && a.boundsY == b.boundsY &&
+           a.boundsW == b.boundsW && a.boundsH == b.boundsH &&
+           strcmp(a.text, b.text) == 0 && strcmp(a.value, b.value) == 0;
+}
+
+/**
+ * @brief Draws a widget into the display buffer
+ */
+void drawWidget(const Widget &widget) {
+    switch (widget.type) {
+        case WIDGET_HEADER:
+            drawHeader(widget.text);
+            break;
+            
+        case WIDGET_LABEL:
+        case WIDGET_UID:
+            display.setFont(widget.font);
+            display.setTextColor(widget.color);
+            display.setCursor(widget.x, widget.y);
+            display.print(widget.text);
+            break;
+            
+        case WIDGET_LIST_ITEM:
+            display.setFont(widget.font);
+            display.setTextColor(widget.color);
+            if (widget.selected) {
+                display.setCursor(widget.x - WIDGET_ARROW_OFFSET, widget.y);
+                display.print(">");
+            }
+            display.setCursor(widget.x, widget.y);
+            display.print(widget.text);
+            break;
+            
+        case WIDGET_FIELD:
+            display.setFont(widget.font);
+            display.setTextColor(GxEPD_BLACK);
+            display.setCursor(widget.x, widget.y);
+            display.print(widget.text);
+            display.setTextColor(widget.color);
+            display.print(widget.value);
+            if (widget.selected) {
+                display.setTextColor(GxEPD_RED);
+                display.setCursor(widget.x - WIDGET_ARROW_OFFSET, widget.y);
+                display.print(">");
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Adds a widget's bounds to the dirty rectangle
+ */
+void addDirtyRect(int16_t &dirtyX1, int16_t &dirtyY1, int16_t &dirtyX2, int16_t &dirtyY2, const Widget &widget) {
+    if (widget.boundsW == 0 || widget.boundsH == 0) return;
+    dirtyX1 = min(dirtyX1, widget.boundsX);
+    dirtyY1 = min(dirtyY1, widget.boundsY);
+    dirtyX2 = max(dirtyX2, (int16_t)(widget.boundsX + widget.boundsW));
+    dirtyY2 = max(dirtyY2, (int16_t)(widget.boundsY + widget.boundsH));
+}
+
+/**
+ * @brief Renders renderWidgets to the panel
+ * 
+ * Widgets that differ from the last rendered frame (changed, added or
+ * removed) are unioned into one dirty rectangle, which is refreshed
+ * with a partial window. Unchanged frames cost nothing, the first frame
+ * after initialization uses the full window. Runs in the display task.
+ */
+void renderFrame() {
+    acquireDisplayBus();
+    initDisplay();
+    
+    if (!frameShown) {
+        display.setFullWindow();
+        display.fillScreen(GxEPD_WHITE);
+        for (uint8_t widgetIndex = 0; widgetIndex < renderWidgetCount; widgetIndex++) {
+            drawWidget(renderWidgets[widgetIndex]);
+        }
+        display.display(true);
+    } else {
+        // Union of old and new bounds of every changed slot
+        int16_t dirtyX1 = display.width(), dirtyY1 = display.height();
+        int16_t dirtyX2 = 0, dirtyY2 = 0;
+        uint8_t slotCount = max(renderWidgetCount, shownWidgetCount);
+        for (uint8_t widgetIndex = 0; widgetIndex < slotCount; widgetIndex++) {
+            bool inFrame = widgetIndex < renderWidgetCount;
+            bool inShown = widgetIndex < shownWidgetCount;
+            if (inFrame && inShown && 
+                widgetEquals(renderWidgets[widgetIndex], shownWidgets[widgetIndex])) {
+                continue;
+            }
+            if (inFrame) addDirtyRect(dirtyX1, dirtyY1, dirtyX2, dirtyY2, renderWidgets[widgetIndex]);
+            if (inShown) addDirtyRect(dirtyX1, dirtyY1, dirtyX2, dirtyY2, shownWidgets[widgetIndex]);
+        }
+        
+        // Clip to the panel
+        dirtyX1 = max(dirtyX1, (int16_t)0);
+        dirtyY1 = max(dirtyY1, (int16_t)0);
+        dirtyX2 = min(dirtyX2, (int16_t)display.width());
+        dirtyY2 = min(dirtyY2, (int16_t)display.height());
+        if (dirtyX2 <= dirtyX1 || dirtyY2 <= dirtyY1) {
+            releaseDisplayBus();
+            return;
+        }
+        
+        // Whole frame is drawn, GxEPD2 clips it to the window
+        display.setPartialWindow(dirtyX1, dirtyY1, dirtyX2 - dirtyX1, dirtyY2 - dirtyY1);
+        display.firstPage();
+        do {
+            display.fillScreen(GxEPD_WHITE);
+            for (uint8_t widgetIndex = 0; widgetIndex < renderWidgetCount; widgetIndex++) {
+                drawWidget(renderWidgets[widgetIndex]);
+            }
+        } while (display.nextPage());
+    }
+    
+    releaseDisplayBus();
+    memcpy(shownWidgets, renderWidgets, sizeof(Widget) * renderWidgetCount);
+    shownWidgetCount = renderWidgetCount;
+    frameShown = true;
+}
+
+/**
+ * @brief Hands the frame built since beginFrame() to the display task
+ * 
+ * Returns right away. A frame that is still pending (the panel is busy
+ * with an earlier refresh) is replaced, so only the latest is rendered.
+ */
+void commitFrame() {
+    portENTER_CRITICAL(&displayFrameMux);
+    memcpy(pendingWidgets, frameWidgets, sizeof(Widget) * frameWidgetCount);
+    pendingWidgetCount = frameWidgetCount;
+    framePending = true;
+    portEXIT_CRITICAL(&displayFrameMux);
+    
+    xTaskNotifyGive(displayTaskHandle);
+}
+
+/**
+ * @brief Checks if the display task has nothing left to do
+ * 
+ * @return true if no frame is pending and no refresh is running
+ */
+bool displayIdle() {
+    return !framePending && !displayRefreshActive;
+}
+
+/**
+ * @brief Blocks until all committed frames are on the panel
+ */
+void waitForDisplayIdle() {
+    while (!displayIdle()) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+// ========== DISPLAY TASK ==========
+/**
+ * @brief Display task, renders committed frames
+ * 
+ * Sleeps until commitFrame() notifies it, takes the latest pending frame
+ * and renders it. Frames committed during a refresh are coalesced.
+ */
+void displayTask(void *parameter) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        for (;;) {
+            portENTER_CRITICAL(&displayFrameMux);
+            bool hasFrame = framePending;
+            if (hasFrame) {
+                memcpy(renderWidgets, pendingWidgets, sizeof(Widget) * pendingWidgetCount);
+                renderWidgetCount = pendingWidgetCount;
+                framePending = false;
+                displayRefreshActive = true;
+            }
+            portEXIT_CRITICAL(&displayFrameMux);
+            if (!hasFrame) break;
+            
+            unsigned long refreshStart = millis();
+            renderFrame();
+            displayRefreshActive = false;
+            
+            Serial.print("ePaper refresh done in ");
+            Serial.print(millis() - refreshStart);
+            Serial.println(" ms");
+        }
+    }
+}
+
+// ========== E-PAPER DISPLAY SCREENS ==========
+/**
+ * @brief Formats a UID as upper case hex bytes separated by spaces
+ * 
+ * @param uid UID bytes
+ * @param uidLength Number of UID bytes (up to 10)
+ * @param text Output buffer, UID_TEXT_LENGTH bytes
+ */
+void formatUID(const uint8_t *uid, uint8_t uidLength, char *text) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    char *out = text;
+    for (uint8_t byteIndex = 0; byteIndex < uidLength && byteIndex < 10; byteIndex++) {
+        if (byteIndex > 0) *out++ = ' ';
+        *out++ = HEX_DIGITS[uid[byteIndex] >> 4];
+        *out++ = HEX_DIGITS[uid[byteIndex] & 0x0F];
+    }
+    *out = '\0';
+}
+
+/**
+ * @brief Screen and log text of an access decision
+ */
+const char *accessDecisionText(AccessDecision access) {
+    switch (access) {
+        case ACCESS_ALLOWED: return "ACCESS GRANTED";
+        case ACCESS_DENIED:  return "ACCESS DENIED";
+        case ACCESS_UNKNOWN: return "UNKNOWN CARD";
+        default:             return "";
+    }
+}
+
+/**
+ * @brief Builds the NFC screen
+ * 
+ * @param uid Card UID string, empty if no card is present
+ * @param label Caption above the UID
+ * @param access Allow-list decision shown below the UID
+ * 
+ * Header and footer are static, so a card tap only changes the body
+ */
+void buildNfcScreen(const char *uid, const char *label, AccessDecision access) {
+    // Define layout positions
+    const uint16_t LEFT_MARGIN = 20;
+    const uint16_t READY_Y_POSITION = 80;
+    const uint16_t STANDARD_Y_POSITION = 105;
+    const uint16_t LABEL_Y_POSITION = 70;
+    const uint16_t UID_Y_POSITION = 102;
+    const uint16_t ACCESS_Y_POSITION = 123;
+    const uint16_t INSTRUCTION_Y_POSITION = display.height() - 15;
+    
+    beginFrame();
+    addHeader("NFC MODE");
+    addLabel("Press B1 to switch mode", LEFT_MARGIN, INSTRUCTION_Y_POSITION, 
+             &FreeMonoBold9pt7b, GxEPD_BLACK);
+    
+    if (uid[0] != '\0') {
+        // Display card UID
+        addLabel(label, WIDGET_CENTERED, LABEL_Y_POSITION, &FreeMonoBold9pt7b, GxEPD_BLACK);
+        addUIDField(uid, UID_Y_POSITION);
+        if (access != ACCESS_NO_LIST) {
+            addLabel(accessDecisionText(access), WIDGET_CENTERED, ACCESS_Y_POSITION, &FreeMonoBold9pt7b, 
+                     (access == ACCESS_ALLOWED) ? GxEPD_BLACK : GxEPD_RED);
+        }
+    } else {
+        // Display centered status messages
+        addLabel("Tap card to read", WIDGET_CENTERED, READY_Y_POSITION, &FreeMonoBold12pt7b, GxEPD_BLACK);
+        addLabel("ISO14443A", WIDGET_CENTERED, STANDARD_Y_POSITION, &FreeMonoBold9pt7b, GxEPD_BLACK);
+    }
+    commitFrame();
+}
+
+/**
+ * @brief Displays the NFC ready screen (no card detected)
+ * 
+ * Shows NFC mode header with instructions
+ */
+void displayNoCardScreen() {
+    buildNfcScreen("", "", ACCESS_NO_LIST);
+}
+
+/**
+ * @brief Displays detected card UID
+ * 
+ * @param uid Card UID bytes
+ * @param uidLength Number of UID bytes
+ * @param type Card type, shown as caption
+ * @param access Allow-list decision
+ * 
+ * Shows UID in large font with instructions
+ */
+void showUIDSmall(const uint8_t *uid, uint8_t uidLength, PN5180CardType type, 
+                  AccessDecision access) {
+    char uidText[UID_TEXT_LENGTH];
+    formatUID(uid, uidLength, uidText);
+    buildNfcScreen(uidText, (type == PN5180_CARD_UNKNOWN) ? "Card UID" : PN5180CardTypeName(type), 
+                   access);
+}
+
+/**
+ * @brief Displays main WiFi mode menu
+ * 
+ * Shows two options: Scan WiFi and Manual Connect
+ * Uses red highlight for selected option, the header shows the
+ * connection state
+ */
+void displayWifiMainMenu() {
+    // Define layout parameters
+    const uint16_t LEFT_MARGIN = 20;
+    const uint16_t INSTRUCTION1_Y_POSITION = display.height() - 30;
+    const uint16_t INSTRUCTION2_Y_POSITION = display.height() - 15;
+    const char *menuOptions[2] = {"1. Scan WiFi", "2. Manual Connect"};
+    const char *headerText[4] = {"WiFi MODE", "Connecting", "Connected", "WiFi failed"};
+    
+    beginFrame();
+    addHeader(headerText[wifiConnectState]);
+    
+    // Display centered instructions
+    addLabel("Press B2 to select", WIDGET_CENTERED, INSTRUCTION1_Y_POSITION, 
+             &FreeMonoBold9pt7b, GxEPD_BLACK);
+    addLabel("Hold B1 to confirm", WIDGET_CENTERED, INSTRUCTION2_Y_POSITION, 
+             &FreeMonoBold9pt7b, GxEPD_BLACK);
+    
+    // Display menu options
+    for (int optionIndex = 0; optionIndex < 2; optionIndex++) {
+        addListItem(menuOptions[optionIndex], LEFT_MARGIN, 
+                    MENU_START_Y + (optionIndex * MENU_LINE_HEIGHT), 
+                    &FreeMonoBold12pt7b, optionIndex == wifiMenuSelection);
+    }
+    commitFrame();
+}
+
+/**
+ * @brief Displays WiFi scanning screen
+ * 
+ * Shows list of available WiFi networks (SSID, RSSI) with selection
+ * indicator, redrawn after every scanned channel
+ */
+void displayScanWifiScreen() {
+    // Define layout parameters
+    const uint16_t LEFT_MARGIN = 20;
+    
+    beginFrame();
+    addHeader(wifiScanChannel != 0 || wifiScanRequested ? "Scanning..." : "Scan WiFi");
     
+    if (wifiNetworkCount == 0) {
+        bool searching = wifiScanChannel != 0 || wifiScanRequested || !wifiScanValid;
+        addLabel(searching ? "Searching..." : "No networks found", LEFT_MARGIN, MENU_START_Y, 
+                 &FreeMonoBold9pt7b, GxEPD_BLACK);
+    }
+    
+    // Display the window of WIFI_LIST_ROWS networks around the selection
+    int firstIndex = (scanWifiSelection >= WIFI_LIST_ROWS) ? scanWifiSelection - WIFI_LIST_ROWS + 1 : 0;
+    for (int row = 0; row < WIFI_LIST_ROWS && firstIndex + row < wifiNetworkCount; row++) {
+        int networkIndex = firstIndex + row;
+        char itemText[WIDGET_TEXT_LENGTH];
+        snprintf(itemText, sizeof(itemText), "%d. %-14.14s%4d", networkIndex + 1, 
+                 wifiNetworks[networkIndex].ssid, wifiNetworks[networkIndex].rssi);
+        addListItem(itemText, LEFT_MARGIN, MENU_START_Y + (row * LIST_LINE_HEIGHT), 
+                    &FreeMonoBold9pt7b, networkIndex == scanWifiSelection);
+    }
+    commitFrame();
+}
+
+/**
+ * @brief Displays manual WiFi connection screen
+ * 
+ * Shows SSID and password fields with input indicators
+ */
+void displayManualConnectScreen() {
     // Define layout parameters
     const uint16_t LEFT_MARGIN = 20;
-    const uint16_t START_Y_POSITION = 70;
-    const uint16_t LINE_HEIGHT = 25;
     const uint16_t INSTRUCTION1_Y_POSITION = display.height() - 30;
     const uint16_t INSTRUCTION2_Y_POSITION = display.height() - 15;
     
-    // Set base font and color
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setTextColor(GxEPD_BLACK);
+    beginFrame();
+    addHeader("Manual Connect");
+    
+    // Display instructions
+    addLabel("Press B2 to switch field", LEFT_MARGIN, INSTRUCTION1_Y_POSITION, 
+             &FreeMonoBold9pt7b, GxEPD_BLACK);
+    addLabel("Press B1 to exit", LEFT_MARGIN, INSTRUCTION2_Y_POSITION, 
+             &FreeMonoBold9pt7b, GxEPD_BLACK);
     
     // Display SSID field
-    display.setCursor(LEFT_MARGIN, START_Y_POSITION);
-    display.print("SSID: ");
+    addField("SSID: ", manualSSID.length() > 0 ? manualSSID.c_str() : "__________", 
+             LEFT_MARGIN, MENU_START_Y, manualInputField == 0);
+    
+    // Show password as asterisks
+    char passwordDisplay[WIDGET_TEXT_LENGTH] = "__________"; // Placeholder
+    if (manualPassword.length() > 0) {
+        size_t maskLength = min((size_t)manualPassword.length(), sizeof(passwordDisplay) - 1);
+        memset(passwordDisplay, '*', maskLength);
+        passwordDisplay[maskLength] = '\0';
+    }
+    addField("Password: ", passwordDisplay, LEFT_MARGIN, MENU_START_Y + LIST_LINE_HEIGHT, 
+             manualInputField == 1);
+    commitFrame();
+}
+
+/**
+ * @brief Displays system startup screen
+ * 
+ * Shows "Starting..." message during initialization
+ */
+void displayStartingScreen() {
+    beginFrame();
+    addLabel("Starting...", WIDGET_CENTERED, display.height() / 2, &FreeMonoBold18pt7b, GxEPD_BLACK);
+    commitFrame();
+}
+
+// ========== WIFI CONNECTION ==========
+/**
+ * @brief Loads the last successful connection from Preferences
+ */
+void loadWifiCredentials() {
+    WifiCredentials credentials;
+    memset(&credentials, 0, sizeof(credentials));
+    
+    Preferences preferences;
+    if (preferences.begin("wifi", true)) {
+        preferences.getString("ssid", credentials.ssid, sizeof(credentials.ssid));
+        preferences.getString("password", credentials.password, sizeof(credentials.password));
+        preferences.getBytes("bssid", credentials.bssid, sizeof(credentials.bssid));
+        credentials.channel = preferences.getUChar("channel", 0);
+        preferences.end();
+    }
     
-    if (manualInputField == 0) {
-        display.setTextColor(GxEPD_BLUE); // Active field: blue
+    portENTER_CRITICAL(&storedWifiMux);
+    storedWifi = credentials;
+    portEXIT_CRITICAL(&storedWifiMux);
+}
+
+/**
+ * @brief Stores a connection, flash is written only on changes
+ */
+void saveWifiCredentials(const WifiCredentials &credentials) {
+    portENTER_CRITICAL(&storedWifiMux);
+    bool changed = memcmp(&storedWifi, &credentials, sizeof(credentials)) != 0;
+    storedWifi = credentials;
+    portEXIT_CRITICAL(&storedWifiMux);
+    if (!changed) {
+        return;
     }
     
-    if (manualSSID.length() > 0) {
-        display.println(manualSSID);
+    Preferences preferences;
+    if (preferences.begin("wifi", false)) {
+        preferences.putString("ssid", credentials.ssid);
+        preferences.putString("password", credentials.password);
+        preferences.putBytes("bssid", credentials.bssid, sizeof(credentials.bssid));
+        preferences.putUChar("channel", credentials.channel);
+        preferences.end();
+    }
+}
+
+/**
+ * @brief Copies the stored connection
+ * 
+ * @return false if nothing was stored yet
+ */
+bool getStoredWifi(WifiCredentials &credentials) {
+    portENTER_CRITICAL(&storedWifiMux);
+    credentials = storedWifi;
+    portEXIT_CRITICAL(&storedWifiMux);
+    return credentials.ssid[0] != '\0';
+}
+
+/**
+ * @brief Starts the station, directly on BSSID and channel when known
+ */
+void beginWifi(const WifiCredentials &credentials) {
+    WiFi.mode(WIFI_STA);
+    if (credentials.channel != 0) {
+        WiFi.begin(credentials.ssid, credentials.password, credentials.channel, credentials.bssid);
     } else {
-        display.println("__________"); // Placeholder
+        WiFi.begin(credentials.ssid, credentials.password);
+    }
+}
+
+/**
+ * @brief True while a menu scan or connect needs the radio
+ */
+bool wifiMenuUsesRadio() {
+    return wifiScanRequested || wifiScanChannel != 0 || wifiConnectState == WIFI_STATE_CONNECTING;
+}
+
+/**
+ * @brief Requests a scan unless the cached result is recent
+ */
+void requestWifiScan() {
+    if (wifiScanValid && millis() - wifiScanTime < WIFI_SCAN_CACHE_MS) {
+        return;
+    }
+    if (wifiScanChannel == 0 && wifiConnectState != WIFI_STATE_CONNECTING) {
+        wifiScanRequested = true;
+    }
+}
+
+/**
+ * @brief Merges the results of one scanned channel into wifiNetworks
+ * 
+ * @param count Results reported by WiFi.scanComplete()
+ * 
+ * One entry per SSID (strongest access point), sorted by RSSI and
+ * limited to MAX_WIFI_NETWORKS.
+ */
+void mergeWifiResults(int16_t count) {
+    for (int16_t result = 0; result < count; result++) {
+        String ssid = WiFi.SSID(result);
+        int8_t rssi = WiFi.RSSI(result);
+        if (ssid.length() == 0) {
+            continue; // Hidden network
+        }
+        
+        // Drop a weaker entry of the same SSID
+        int existing = -1;
+        for (int index = 0; index < wifiNetworkCount; index++) {
+            if (strcmp(wifiNetworks[index].ssid, ssid.c_str()) == 0) {
+                existing = index;
+                break;
+            }
+        }
+        if (existing >= 0) {
+            if (wifiNetworks[existing].rssi >= rssi) {
+                continue;
+            }
+            memmove(&wifiNetworks[existing], &wifiNetworks[existing + 1], 
+                    (wifiNetworkCount - existing - 1) * sizeof(WifiNetwork));
+            wifiNetworkCount--;
+        }
+        
+        // Insert sorted by RSSI
+        int position = 0;
+        while (position < wifiNetworkCount && wifiNetworks[position].rssi >= rssi) {
+            position++;
+        }
+        if (position >= MAX_WIFI_NETWORKS) {
+            continue;
+        }
+        int moved = min(wifiNetworkCount - position, MAX_WIFI_NETWORKS - position - 1);
+        memmove(&wifiNetworks[position + 1], &wifiNetworks[position], moved * sizeof(WifiNetwork));
+        if (wifiNetworkCount < MAX_WIFI_NETWORKS) {
+            wifiNetworkCount++;
+        }
+        
+        WifiNetwork &network = wifiNetworks[position];
+        strncpy(network.ssid, ssid.c_str(), sizeof(network.ssid) - 1);
+        network.ssid[sizeof(network.ssid) - 1] = '\0';
+        network.rssi = rssi;
+        network.channel = WiFi.channel(result);
+        memcpy(network.bssid, WiFi.BSSID(result), sizeof(network.bssid));
+        network.open = (WiFi.encryptionType(result) == WIFI_AUTH_OPEN);
+    }
+}
+
+/**
+ * @brief Advances the channel by channel async scan
+ * 
+ * Each channel is a separate WiFi.scanNetworks(async), its results
+ * are shown right away instead of after the full scan.
+ */
+void serviceWifiScan() {
+    if (wifiScanRequested && !uplinkBusy) {
+        wifiScanRequested = false;
+        wifiNetworkCount = 0;
+        scanWifiSelection = 0;
+        wifiScanChannel = 1;
+        WiFi.mode(WIFI_STA);
+        WiFi.scanNetworks(true, false, false, WIFI_SCAN_MS_PER_CHANNEL, wifiScanChannel);
+        displayUpdateRequired = true;
+        return;
+    }
+    if (wifiScanChannel == 0) {
+        return;
     }
     
-    // Display Password field
-    display.setTextColor(GxEPD_BLACK);
-    display.setCursor(LEFT_MARGIN, START_Y_POSITION + LINE_HEIGHT);
-    display.print("Password: ");
+    int16_t result = WiFi.scanComplete();
+    if (result == WIFI_SCAN_RUNNING) {
+        return;
+    }
+    if (result > 0) {
+        mergeWifiResults(result);
+        displayUpdateRequired = true;
+    }
+    WiFi.scanDelete();
     
-    if (manualInputField == 1) {
-        display.setTextColor(GxEPD_BLUE); // Active field: blue
+    if (++wifiScanChannel > WIFI_SCAN_CHANNELS) {
+        wifiScanChannel = 0;
+        wifiScanValid = true;
+        wifiScanTime = millis();
+        displayUpdateRequired = true;
+        Serial.print("WiFi scan done, networks: ");
+        Serial.println(wifiNetworkCount);
+    } else {
+        WiFi.scanNetworks(true, false, false, WIFI_SCAN_MS_PER_CHANNEL, wifiScanChannel);
+    }
+}
+
+/**
+ * @brief Starts a background connection from the menu
+ * 
+ * @param bssid Access point from the scan, NULL to let the stack choose
+ * @param channel Channel of bssid, 0 if unknown
+ */
+void startWifiConnect(const char *ssid, const char *password, const uint8_t *bssid, uint8_t channel) {
+    memset(&wifiPending, 0, sizeof(wifiPending));
+    strncpy(wifiPending.ssid, ssid, sizeof(wifiPending.ssid) - 1);
+    strncpy(wifiPending.password, password, sizeof(wifiPending.password) - 1);
+    if (bssid != NULL) {
+        memcpy(wifiPending.bssid, bssid, sizeof(wifiPending.bssid));
+        wifiPending.channel = channel;
     }
     
-    // Show password as asterisks
-    String passwordDisplay = "";
-    if (manualPassword.length() > 0) {
-        for (int charIndex = 0; charIndex < manualPassword.length(); charIndex++) {
-            passwordDisplay += "*";
+    // A running scan would delay the association
+    if (wifiScanChannel != 0) {
+        wifiScanChannel = 0;
+        WiFi.scanDelete();
+    }
+    wifiScanRequested = false;
+    wifiConnectState = WIFI_STATE_CONNECTING;
+    wifiConnectStart = 0;
+    displayUpdateRequired = true;
+    Serial.print("Connecting to ");
+    Serial.println(wifiPending.ssid);
+}
+
+/**
+ * @brief Follows the menu connection, stores it once associated
+ */
+void serviceWifiConnect() {
+    if (wifiConnectState == WIFI_STATE_CONNECTED && WiFi.status() != WL_CONNECTED) {
+        wifiConnectState = WIFI_STATE_IDLE;
+        displayUpdateRequired = true;
+        Serial.println("WiFi connection lost");
+        return;
+    }
+    if (wifiConnectState != WIFI_STATE_CONNECTING) {
+        return;
+    }
+    if (wifiConnectStart == 0) {
+        if (uplinkBusy) {
+            return;
+        }
+        WiFi.disconnect();
+        beginWifi(wifiPending);
+        wifiConnectStart = millis();
+        return;
+    }
+    
+    wl_status_t status = WiFi.status();
+    if (status == WL_CONNECTED) {
+        // BSSID and channel of the association for the next fast reconnect
+        memcpy(wifiPending.bssid, WiFi.BSSID(), sizeof(wifiPending.bssid));
+        wifiPending.channel = WiFi.channel();
+        saveWifiCredentials(wifiPending);
+        
+        wifiSSID = wifiPending.ssid;
+        wifiIP = WiFi.localIP().toString();
+        wifiConnectState = WIFI_STATE_CONNECTED;
+        displayUpdateRequired = true;
+        Serial.print("WiFi connected, IP: ");
+        Serial.println(wifiIP);
+    } else if (status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL || 
+               millis() - wifiConnectStart >= WIFI_CONNECT_TIMEOUT_MS) {
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+        wifiConnectState = WIFI_STATE_FAILED;
+        displayUpdateRequired = true;
+        Serial.print("WiFi connect failed: ");
+        Serial.println(wifiPending.ssid);
+    }
+}
+
+/**
+ * @brief Switches the radio off when the WiFi menu is left unconnected
+ */
+void releaseWifiRadio() {
+    wifiScanRequested = false;
+    if (wifiScanChannel != 0) {
+        wifiScanChannel = 0;
+        WiFi.scanDelete();
+    }
+    if (wifiConnectState != WIFI_STATE_CONNECTED && wifiConnectState != WIFI_STATE_CONNECTING && 
+        !uplinkBusy) {
+        WiFi.mode(WIFI_OFF);
+    }
+}
+
+/**
+ * @brief Password for a scanned network
+ * 
+ * @return Stored or configured password, "" for open networks,
+ *         NULL if the password is unknown
+ */
+const char *wifiPasswordFor(const WifiNetwork &network) {
+    static WifiCredentials stored;
+    if (getStoredWifi(stored) && strcmp(stored.ssid, network.ssid) == 0) {
+        return stored.password;
+    }
+    if (strcmp(WIFI_SSID, network.ssid) == 0) {
+        return WIFI_PASSWORD;
+    }
+    return network.open ? "" : NULL;
+}
+
+// ========== BUTTON EVENT HANDLERS ==========
+/**
+ * @brief Handles Mode button short press events
+ * 
+ * Manages mode switching between NFC and WiFi
+ * Handles submenu navigation in WiFi mode
+ */
+void handleModeButtonPress() {
+    if (!systemReady) return;
+    
+    if (currentMode == MODE_NFC) {
+        // Switch from NFC to WiFi mode
+        currentMode = MODE_WIFI;
+        currentWifiSubMode = WIFI_SUB_NONE;
+        displayUpdateRequired = true;
+        Serial.println("Mode switched to: WiFi");
+    } 
+    else if (currentMode == MODE_WIFI) {
+        if (currentWifiSubMode != WIFI_SUB_NONE) {
+            // Exit submenu, return to main WiFi menu
+            currentWifiSubMode = WIFI_SUB_NONE;
+            displayUpdateRequired = true;
+            Serial.println("Exited WiFi sub menu");
+        } else {
+            // Exit WiFi mode, return to NFC mode
+            releaseWifiRadio();
+            currentMode = MODE_NFC;
+            displayUpdateRequired = true;
+            Serial.println("Mode switched to: NFC");
+        }
+    }
+}
+
+/**
+ * @brief Handles Mode button long press events
+ * 
+ * Used for menu confirmation in WiFi mode, connects to the selected
+ * network in the scan and manual submenus
+ */
+void handleModeButtonLongPress() {
+    if (!systemReady) return;
+    
+    if (currentMode == MODE_WIFI && currentWifiSubMode == WIFI_SUB_NONE) {
+        // Confirm menu selection in WiFi mode
+        if (wifiMenuSelection == 0) {
+            currentWifiSubMode = WIFI_SUB_SCAN;
+            requestWifiScan();
+            Serial.println("Entered Scan WiFi mode");
+        } else {
+            currentWifiSubMode = WIFI_SUB_MANUAL;
+            Serial.println("Entered Manual Connect mode");
+        }
+        displayUpdateRequired = true;
+    }
+    else if (currentMode == MODE_WIFI && currentWifiSubMode == WIFI_SUB_SCAN) {
+        // Connect to the selected network
+        if (wifiNetworkCount == 0) return;
+        const WifiNetwork &network = wifiNetworks[scanWifiSelection];
+        const char *password = wifiPasswordFor(network);
+        if (password == NULL) {
+            // No keyboard, the password must come from Manual Connect
+            manualSSID = network.ssid;
+            Serial.print("No password stored for ");
+            Serial.println(network.ssid);
+            return;
+        }
+        startWifiConnect(network.ssid, password, network.bssid, network.channel);
+        currentWifiSubMode = WIFI_SUB_NONE;
+    }
+    else if (currentMode == MODE_WIFI && currentWifiSubMode == WIFI_SUB_MANUAL) {
+        // Connect with the manual fields
+        if (manualSSID.length() == 0) return;
+        startWifiConnect(manualSSID.c_str(), manualPassword.c_str(), NULL, 0);
+        currentWifiSubMode = WIFI_SUB_NONE;
+    }
+}
+
+/**
+ * @brief Handles Select button press events
+ * 
+ * Manages menu navigation and field selection
+ */
+void handleSelectButtonPress() {
+    if (!systemReady) return;
+    
+    if (currentMode == MODE_WIFI) {
+        if (currentWifiSubMode == WIFI_SUB_NONE) {
+            // Cycle through main WiFi menu options
+            wifiMenuSelection = (wifiMenuSelection + 1) % 2;
+            displayUpdateRequired = true;
+            Serial.print("WiFi menu selection: ");
+            Serial.println(wifiMenuSelection == 0 ? "Scan WiFi" : "Manual Connect");
+        }
+        else if (currentWifiSubMode == WIFI_SUB_SCAN) {
+            // Cycle through available WiFi networks
+            if (wifiNetworkCount == 0) return;
+            scanWifiSelection = (scanWifiSelection + 1) % wifiNetworkCount;
+            displayUpdateRequired = true;
+            Serial.print("Selected WiFi: ");
+            Serial.println(wifiNetworks[scanWifiSelection].ssid);
+        }
+        else if (currentWifiSubMode == WIFI_SUB_MANUAL) {
+            // Switch between SSID and Password fields
+            manualInputField = (manualInputField + 1) % 2;
+            displayUpdateRequired = true;
+            Serial.print("Manual input field: ");
+            Serial.println(manualInputField == 0 ? "SSID" : "Password");
+        }
+    }
+}
+
+/**
+ * @brief Dispatches a button event from buttonEventQueue
+ * 
+ * @param event Event received from buttonEventQueue
+ */
+void handleButtonEvent(const ButtonEvent &event) {
+    if (event.button == BUTTON_MODE) {
+        if (event.type == BUTTON_EVENT_LONG_PRESS) {
+            handleModeButtonLongPress();
+        } else {
+            handleModeButtonPress();
         }
-        display.println(passwordDisplay);
     } else {
-        display.println("__________"); // Placeholder
+        // Held Select keeps scrolling through the menu
+        handleSelectButtonPress();
+    }
+}
+
+// ========== NFC CARD READING FUNCTION ==========
+/**
+ * @brief Activates a Type A card without blocking the core
+ * 
+ * @param responseBuffer 10 byte buffer, ATQA, SAK and UID
+ * @param kind 0 = REQA, 1 = WUPA (also wakes halted cards)
+ * @return Same as activateTypeA()
+ * 
+ * The reader is advanced frame by frame, the task sleeps while the
+ * card answers so other work on NFC_TASK_CORE can run.
+ */
+int8_t activateCard(uint8_t *responseBuffer, uint8_t kind) {
+    if (!nfc.startActivateTypeA(responseBuffer, kind)) {
+        return nfc.activateResult();
+    }
+    while (nfc.poll()) {
+        vTaskDelay(1);
+    }
+    return nfc.activateResult();
+}
+
+/**
+ * @brief Reads NFC card and extracts UID
+ * 
+ * @param uidBuffer Buffer to store extracted UID
+ * @param kind 0 = REQA, 1 = WUPA
+ * @return Length of UID (4, 7) or negative error code:
+ *         -1 reader error (SPI, BUSY timeout), -2 card answered
+ *         REQA/WUPA but failed anti collision or select (marginal card),
+ *         -3 invalid card data
+ * 
+ * Performs complete NFC card activation and validation, the card
+ * type of a valid card is stored in nfcCardType
+ */
+int8_t readCard(uint8_t *uidBuffer, uint8_t kind) {
+    uint8_t responseBuffer[10] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 
+                                  0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    
+    // Activate Type A card and get raw response
+    int8_t rawResponseLength = activateCard(responseBuffer, kind);
+    
+    // Check for activation errors
+    if (rawResponseLength <= 0) {
+        return rawResponseLength;
+    }
+    
+    // Validate response length
+    if (rawResponseLength != 4 && 
+        (NFC_MAX_UID_LENGTH < 7 || rawResponseLength != 7)) {
+        return -3; // Invalid length error
     }
     
-    // Draw selection arrow for active field
-    display.setTextColor(GxEPD_RED);
-    display.setCursor(LEFT_MARGIN - 15, START_Y_POSITION + (manualInputField * LINE_HEIGHT));
-    display.print(">");
+    // Validate ATQA, SAK and UID with the library tables
+    uint16_t atqaValue = (responseBuffer[1] << 8) | responseBuffer[0];
+    uint8_t sakValue = responseBuffer[2];
+    if (!PN5180IsValidATQA(atqaValue) || !PN5180IsValidSAK(sakValue) ||
+        !PN5180IsValidUID(&responseBuffer[3], rawResponseLength)) {
+        return -3; // Invalid card data error
+    }
     
-    // Display instructions
-    display.setTextColor(GxEPD_BLACK);
-    display.setFont(&FreeMonoBold9pt7b);
+    // Copy UID to output buffer
+    memcpy(uidBuffer, &responseBuffer[3], rawResponseLength);
+    nfcCardType = PN5180GetCardType(atqaValue, sakValue);
+    return rawResponseLength;
+}
+
+// ========== NFC LOW POWER IDLE ==========
+/**
+ * @brief Puts PN5180 into LPCD and the ESP32 into light sleep
+ * 
+ * @return true if woken up by the PN5180 LPCD interrupt (card in field)
+ * 
+ * Wake sources are the PN5180 IRQ pin and both buttons. The RF
+ * configuration is restored before returning, so the caller can
+ * run a full activation right away. LPCD is calibrated on the first
+ * call, off the boot path and with no card in the field.
+ */
+bool enterNfcIdle() {
+    if (!lpcdReady) {
+        // Calibrate Low Power Card Detection against the antenna (RF on, no card)
+        lpcdReady = nfc.calibrateLPCD(lpcdConfig);
+        Serial.print("LPCD threshold=0x");
+        Serial.println(lpcdConfig.threshold, HEX);
+        if (!lpcdReady) return false;
+    }
+    
+    Serial.println("Entering LPCD idle...");
+    Serial.flush();
+    
+    if (!nfc.switchToLPCD(LPCD_WAKEUP_INTERVAL_MS)) {
+        Serial.println("LPCD switch failed");
+        return false;
+    }
+    
+    // Wake up on PN5180 IRQ or any button press
+    gpio_wakeup_enable((gpio_num_t)PN5180_IRQ_PIN, 
+                       nfcIrqWakeLevel ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)MODE_BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)SELECT_BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    
+    esp_light_sleep_start();
+    
+    gpio_wakeup_disable((gpio_num_t)PN5180_IRQ_PIN);
+    gpio_wakeup_disable((gpio_num_t)MODE_BUTTON_PIN);
+    gpio_wakeup_disable((gpio_num_t)SELECT_BUTTON_PIN);
+    
+    resyncButtons();
+    
+    uint32_t irqStatus = nfc.getIRQStatus();
+    nfc.clearIRQStatus(0xffffffff);
+    
+    if (irqStatus & LPCD_IRQ_STAT) {
+        // PN5180 left LPCD by itself, only RF needs to be restored
+        nfc.setupRF();
+        return true;
+    }
+    
+    // Woken up by a button, PN5180 is still in LPCD
+    nfc.reset();
+    nfc.setupRF();
+    return false;
+}
+
+// ========== DISPLAY MODE MANAGEMENT ==========
+/**
+ * @brief Updates display based on current system state
+ * 
+ * Controls which screen is shown based on mode and sub-mode
+ * Prevents unnecessary screen refreshes
+ */
+void updateDisplay() {
+    // Check if display update is needed
+    if (!displayUpdateRequired && 
+        currentMode == lastDisplayedMode && 
+        currentWifiSubMode == lastWifiSubMode) {
+        return;
+    }
     
-    // Left-aligned instructions
-    display.setCursor(LEFT_MARGIN, INSTRUCTION1_Y_POSITION);
-    display.println("Press B2 to switch field");
+    // Select screen based on current mode
+    switch (currentMode) {
+        case MODE_NFC:
+            if (cardDetected) {
+                showUIDSmall(cardUID, cardUIDLength, cardType, cardAccess);
+            } else {
+                displayNoCardScreen();
+            }
+            break;
+            
+        case MODE_WIFI:
+            switch (currentWifiSubMode) {
+                case WIFI_SUB_NONE:
+                    displayWifiMainMenu();
+                    break;
+                case WIFI_SUB_SCAN:
+                    displayScanWifiScreen();
+                    break;
+                case WIFI_SUB_MANUAL:
+                    displayManualConnectScreen();
+                    break;
+            }
+            break;
+    }
     
-    display.setCursor(LEFT_MARGIN, INSTRUCTION2_Y_POSITION);
-    display.println("Press B1 to exit");
+    // Reset update flags
+    displayUpdateRequired = false;
+    lastDisplayedMode = currentMode;
+    lastWifiSubMode = currentWifiSubMode;
+}
+
+// ========== NFC POLL SCHEDULER ==========
+/**
+ * @brief Restarts fast NFC polling after a button press
+ * 
+ * Called from loop(), wakes the NFC task if it waits for the next poll.
+ */
+void noteNfcActivity() {
+    nfcActivityTime = millis();
+    if (nfcTaskHandle != NULL) {
+        xTaskNotifyGive(nfcTaskHandle);
+    }
+}
+
+/**
+ * @brief Computes the interval until the next empty poll
+ * 
+ * @return NFC_POLL_FAST_MS within NFC_POLL_FAST_PERIOD_MS of the last
+ *         activity, then growing by NFC_POLL_BACKOFF_PERCENT per poll
+ *         up to NFC_POLL_SLOW_MS
+ */
+uint16_t nextPollInterval() {
+    if (millis() - nfcActivityTime < NFC_POLL_FAST_PERIOD_MS) {
+        nfcPollInterval = NFC_POLL_FAST_MS;
+    } else {
+        uint32_t next = nfcPollInterval + (uint32_t)nfcPollInterval * NFC_POLL_BACKOFF_PERCENT / 100;
+        nfcPollInterval = (next > NFC_POLL_SLOW_MS) ? NFC_POLL_SLOW_MS : next;
+    }
+    return nfcPollInterval;
+}
+
+/**
+ * @brief Sleeps until the next poll, returns early on noteNfcActivity()
+ * 
+ * @param intervalMs Poll interval
+ */
+void waitNextPoll(uint16_t intervalMs) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(intervalMs));
+}
+
+// ========== NFC ERROR RECOVERY ==========
+/**
+ * @brief Tiered recovery after a failed card read (negative readCard() result)
+ * 
+ * @param uidBuffer Receives the UID if the retry succeeds
+ * @return readCard() result of the WUPA retry
+ * 
+ * A WUPA retry comes first, it also reaches a card left in HALT or
+ * a half finished activation. Only reader errors (-1) of the retry
+ * escalate: Idle/StopCom, then an RF cycle after NFC_RF_CYCLE_FAILURES
+ * and a hard reset after NFC_HARD_RESET_FAILURES consecutive failures.
+ * A card at the edge of the field (-2) or invalid card data (-3)
+ * never resets the reader.
+ */
+int8_t recoverReader(uint8_t *uidBuffer) {
+    nfc.recover(PN5180_RECOVERY_WUPA);
+    int8_t result = readCard(uidBuffer, 1);
+    if (result != -1) {
+        // Reader works, a marginal card is retried by the next poll
+        nfcFailures = 0;
+        return result;
+    }
     
-    display.display(true);
+    nfcFailures++;
+    if (nfcFailures >= NFC_HARD_RESET_FAILURES) {
+        Serial.println("NFC reader not responding, hard reset");
+        nfc.recover(PN5180_RECOVERY_RESET);
+        nfcFailures = 0;
+    } else if (nfcFailures >= NFC_RF_CYCLE_FAILURES) {
+        nfc.recover(PN5180_RECOVERY_RF_CYCLE);
+    } else {
+        nfc.recover(PN5180_RECOVERY_IDLE);
+    }
+    return result;
+}
+
+// ========== OFFLINE ALLOW-LIST ==========
+/**
+ * @brief Mounts LittleFS and opens the allow-list
+ * 
+ * The list stays in flash, only the record count is kept in RAM.
+ * Records are sorted by their key (length byte, then the UID padded
+ * with zeros), see README.
+ */
+void beginAllowList() {
+    // Format an empty partition, the uplink spill file needs it too
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS not mounted, no allow-list");
+        return;
+    }
+    allowListFile = LittleFS.open(ALLOWLIST_PATH, "r");
+    if (!allowListFile) {
+        Serial.println("No allow-list, access decisions off");
+        return;
+    }
+    if (allowListFile.size() % ALLOWLIST_RECORD_SIZE != 0) {
+        Serial.println("Allow-list size invalid, ignored");
+        allowListFile.close();
+        return;
+    }
+    allowListCount = allowListFile.size() / ALLOWLIST_RECORD_SIZE;
+    Serial.print("Allow-list entries: ");
+    Serial.println(allowListCount);
 }
 
 /**
- * @brief Displays system startup screen
+ * @brief Looks up a UID in the allow-list
  * 
- * Shows "Starting..." message during initialization
+ * @param uid UID bytes from readCard()
+ * @param uidLength Number of UID bytes
+ * @return Access decision, ACCESS_UNKNOWN for UIDs not in the list
+ * 
+ * Binary search over the records in flash, log2(entries) reads of
+ * ALLOWLIST_RECORD_SIZE bytes (14 for 10k cards).
  */
-void displayStartingScreen() {
-    initDisplay();
-    
-    display.setFullWindow();
-    display.fillScreen(GxEPD_WHITE);
-    
-    // Display centered startup message
-    drawCenteredText("Starting...", display.height() / 2, &FreeMonoBold18pt7b, GxEPD_BLACK);
+AccessDecision lookupAllowList(const uint8_t *uid, uint8_t uidLength) {
+    if (allowListCount == 0) {
+        return ACCESS_NO_LIST;
+    }
     
-    display.display(true);
+    uint8_t key[ALLOWLIST_KEY_SIZE] = {0};
+    key[0] = uidLength;
+    memcpy(&key[1], uid, uidLength);
+    
+    uint32_t low = 0;
+    uint32_t high = allowListCount;
+    uint8_t record[ALLOWLIST_RECORD_SIZE];
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (!allowListFile.seek(middle * ALLOWLIST_RECORD_SIZE) || 
+            allowListFile.read(record, ALLOWLIST_RECORD_SIZE) != ALLOWLIST_RECORD_SIZE) {
+            Serial.println("Allow-list read failed");
+            return ACCESS_NO_LIST;
+        }
+        
+        int order = memcmp(record, key, ALLOWLIST_KEY_SIZE);
+        if (order == 0) {
+            return record[ALLOWLIST_KEY_SIZE] ? ACCESS_ALLOWED : ACCESS_DENIED;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return ACCESS_UNKNOWN;
 }
 
-// ========== BUTTON EVENT HANDLERS ==========
+// ========== EVENT UPLINK ==========
 /**
- * @brief Handles Mode button short press events
+ * @brief Appends a card event to the uplink ring
  * 
- * Manages mode switching between NFC and WiFi
- * Handles submenu navigation in WiFi mode
+ * @param event Event posted to the UI
+ * @param latencyUs Card read time (0 for removal)
+ * 
+ * Called by the NFC task, only copies the event under a spinlock.
+ * The uplink task is woken once the ring reaches UPLINK_SPILL_THRESHOLD.
  */
-void handleModeButtonPress() {
-    if (!systemReady) return;
+void queueUplinkEvent(const NfcEvent &event, uint32_t latencyUs) {
+    UplinkEvent record;
+    record.uptimeMs = millis();
+    time_t now = time(NULL);
+    record.epochSeconds = (now > 1600000000) ? (uint32_t)now : 0;
+    record.latencyUs = latencyUs;
+    memcpy(record.uid, event.uid, sizeof(record.uid));
+    record.uidLength = event.uidLength;
+    record.type = event.type;
+    
+    bool wake = false;
+    portENTER_CRITICAL(&uplinkMux);
+    record.boot = uplinkBoot;
+    record.sequence = uplinkSequence++;
+    if (uplinkCount < UPLINK_RING_SIZE) {
+        uplinkRing[(uplinkTail + uplinkCount) % UPLINK_RING_SIZE] = record;
+        uplinkCount++;
+        wake = (uplinkCount == UPLINK_SPILL_THRESHOLD);
+    } else {
+        uplinkDropped++;
+    }
+    portEXIT_CRITICAL(&uplinkMux);
     
-    if (currentMode == MODE_NFC) {
-        // Switch from NFC to WiFi mode
-        currentMode = MODE_WIFI;
-        currentWifiSubMode = WIFI_SUB_NONE;
-        displayUpdateRequired = true;
-        Serial.println("Mode switched to: WiFi");
-    } 
-    else if (currentMode == MODE_WIFI) {
-        if (currentWifiSubMode != WIFI_SUB_NONE) {
-            // Exit submenu, return to main WiFi menu
-            currentWifiSubMode = WIFI_SUB_NONE;
-            displayUpdateRequired = true;
-            Serial.println("Exited WiFi sub menu");
-        } else {
-            // Exit WiFi mode, return to NFC mode
-            currentMode = MODE_NFC;
-            displayUpdateRequired = true;
-            Serial.println("Mode switched to: NFC");
-        }
+    if (wake && uplinkTaskHandle != NULL) {
+        xTaskNotifyGive(uplinkTaskHandle);
     }
 }
 
 /**
- * @brief Handles Mode button long press events
+ * @brief Copies the oldest ring events without removing them
  * 
- * Used for menu confirmation in WiFi mode
+ * @return Number of events copied (at most maxEvents)
  */
-void handleModeButtonLongPress() {
-    if (!systemReady) return;
-    
-    if (currentMode == MODE_WIFI && currentWifiSubMode == WIFI_SUB_NONE) {
-        // Confirm menu selection in WiFi mode
-        if (wifiMenuSelection == 0) {
-            currentWifiSubMode = WIFI_SUB_SCAN;
-            Serial.println("Entered Scan WiFi mode");
-        } else {
-            currentWifiSubMode = WIFI_SUB_MANUAL;
-            Serial.println("Entered Manual Connect mode");
-        }
-        displayUpdateRequired = true;
+uint16_t peekUplinkEvents(UplinkEvent *events, uint16_t maxEvents) {
+    portENTER_CRITICAL(&uplinkMux);
+    uint16_t count = (uplinkCount < maxEvents) ? uplinkCount : maxEvents;
+    for (uint16_t index = 0; index < count; index++) {
+        events[index] = uplinkRing[(uplinkTail + index) % UPLINK_RING_SIZE];
     }
+    portEXIT_CRITICAL(&uplinkMux);
+    return count;
 }
 
 /**
- * @brief Handles Select button press events
+ * @brief Removes the oldest count events after upload or spill
+ */
+void dropUplinkEvents(uint16_t count) {
+    portENTER_CRITICAL(&uplinkMux);
+    uplinkTail = (uplinkTail + count) % UPLINK_RING_SIZE;
+    uplinkCount -= count;
+    portEXIT_CRITICAL(&uplinkMux);
+}
+
+/**
+ * @brief Moves all ring events to the LittleFS spill file
  * 
- * Manages menu navigation and field selection
+ * Runs in the uplink task, so the NFC task never waits for a flash write.
  */
-void handleSelectButtonPress() {
-    if (!systemReady) return;
+void spillUplinkEvents() {
+    File spill = LittleFS.open(UPLINK_SPILL_PATH, "a");
+    if (!spill) {
+        Serial.println("Uplink spill file not writable");
+        return;
+    }
     
-    if (currentMode == MODE_WIFI) {
-        if (currentWifiSubMode == WIFI_SUB_NONE) {
-            // Cycle through main WiFi menu options
-            wifiMenuSelection = (wifiMenuSelection + 1) % 2;
-            displayUpdateRequired = true;
-            Serial.print("WiFi menu selection: ");
-            Serial.println(wifiMenuSelection == 0 ? "Scan WiFi" : "Manual Connect");
-        }
-        else if (currentWifiSubMode == WIFI_SUB_SCAN) {
-            // Cycle through available WiFi networks
-            scanWifiSelection = (scanWifiSelection + 1) % MAX_WIFI_NETWORKS;
-            displayUpdateRequired = true;
-            Serial.print("Selected WiFi: ");
-            Serial.println(wifiNetworks[scanWifiSelection]);
+    UplinkEvent events[UPLINK_BATCH_SIZE];
+    uint16_t count;
+    while ((count = peekUplinkEvents(events, UPLINK_BATCH_SIZE)) > 0) {
+        uint16_t room = (uplinkSpillCount < UPLINK_SPILL_MAX_EVENTS) ? 
+                        UPLINK_SPILL_MAX_EVENTS - uplinkSpillCount : 0;
+        uint16_t written = (count < room) ? count : room;
+        if (written > 0 && 
+            spill.write((const uint8_t *)events, written * sizeof(UplinkEvent)) != written * sizeof(UplinkEvent)) {
+            Serial.println("Uplink spill write failed");
+            break;
         }
-        else if (currentWifiSubMode == WIFI_SUB_MANUAL) {
-            // Switch between SSID and Password fields
-            manualInputField = (manualInputField + 1) % 2;
-            displayUpdateRequired = true;
-            Serial.print("Manual input field: ");
-            Serial.println(manualInputField == 0 ? "SSID" : "Password");
+        uplinkSpillCount += written;
+        if (written < count) {
+            portENTER_CRITICAL(&uplinkMux);
+            uplinkDropped += count - written;
+            portEXIT_CRITICAL(&uplinkMux);
         }
+        dropUplinkEvents(count);
     }
+    spill.close();
 }
 
-// ========== NFC CARD VALIDATION FUNCTIONS ==========
 /**
- * @brief Validates 4-byte UID format
+ * @brief Builds the JSON body of one batch
  * 
- * @param uid Pointer to UID byte array
- * @return true if UID is valid, false otherwise
+ * @return Body length, 0 if the events do not fit UPLINK_BODY_SIZE
+ */
+size_t formatUplinkBatch(const UplinkEvent *events, uint16_t count, char *body) {
+    size_t length = snprintf(body, UPLINK_BODY_SIZE, "{\"reader\":\"%s\",\"events\":[", UPLINK_READER_ID);
+    for (uint16_t index = 0; index < count && length < UPLINK_BODY_SIZE; index++) {
+        const UplinkEvent &event = events[index];
+        char uidText[UID_TEXT_LENGTH];
+        formatUID(event.uid, event.uidLength, uidText);
+        length += snprintf(body + length, UPLINK_BODY_SIZE - length, 
+                           "%s{\"boot\":%lu,\"seq\":%lu,\"type\":\"%s\",\"uid\":\"%s\",\"uptime_ms\":%lu,"
+                           "\"time\":%lu,\"latency_us\":%lu}", 
+                           (index > 0) ? "," : "", (unsigned long)event.boot, (unsigned long)event.sequence, 
+                           (event.type == NFC_EVENT_CARD_ARRIVED) ? "arrived" : "removed",
+                           uidText, (unsigned long)event.uptimeMs, 
+                           (unsigned long)event.epochSeconds, (unsigned long)event.latencyUs);
+    }
+    if (length < UPLINK_BODY_SIZE) {
+        length += snprintf(body + length, UPLINK_BODY_SIZE - length, "]}");
+    }
+    return (length < UPLINK_BODY_SIZE) ? length : 0;
+}
+
+/**
+ * @brief POSTs one batch to UPLINK_URL
  * 
- * Checks for invalid patterns (all zeros, all FFs, reserved values)
+ * @return true on a 2xx response
  */
-bool validate4ByteUID(uint8_t *uid) {
-    // Check for reserved values
-    if (uid[0] == 0x00 || uid[0] == 0x88) return false;
-    
-    // Check for all zeros
-    bool allZero = true;
-    for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
-        if (uid[byteIndex] != 0x00) {
-            allZero = false;
-            break;
-        }
+bool postUplinkBatch(const UplinkEvent *events, uint16_t count) {
+    static char body[UPLINK_BODY_SIZE];
+    size_t length = formatUplinkBatch(events, count, body);
+    if (length == 0) {
+        Serial.println("Uplink batch too large");
+        return false;
     }
-    if (allZero) return false;
     
-    // Check for all FFs
-    bool allFF = true;
-    for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
-        if (uid[byteIndex] != 0xFF) {
-            allFF = false;
-            break;
-        }
+    HTTPClient http;
+    http.setTimeout(UPLINK_HTTP_TIMEOUT_MS);
+    if (!http.begin(UPLINK_URL)) {
+        return false;
+    }
+    http.addHeader("Content-Type", "application/json");
+    int status = http.POST((uint8_t *)body, length);
+    http.end();
+    
+    if (status < 200 || status >= 300) {
+        Serial.print("Uplink POST failed: ");
+        Serial.println(status);
+        return false;
     }
-    if (allFF) return false;
-    
     return true;
 }
 
 /**
- * @brief Validates 7-byte UID format
+ * @brief Uploads the spill file, then the ring, in batches
  * 
- * @param uid Pointer to UID byte array
- * @return true if UID is valid, false otherwise
+ * @return true if everything buffered so far was uploaded
  * 
- * Validates double-size UID format with specific constraints
+ * Events are removed only after the server acknowledged them, an
+ * upload interrupted by a reboot may send a batch twice (same boot
+ * and seq).
  */
-bool validate7ByteUID(uint8_t *uid) {
-    // Check for CT (Cascade Tag) byte
-    if (uid[3] != 0x88) return false;
-    
-    // Validate last 3 bytes (not all zeros)
-    bool last3AllZero = true;
-    for (int byteIndex = 4; byteIndex < 7; byteIndex++) {
-        if (uid[byteIndex] != 0x00) {
-            last3AllZero = false;
-            break;
+bool flushUplinkEvents() {
+    UplinkEvent events[UPLINK_BATCH_SIZE];
+    
+    if (uplinkSpillCount > 0) {
+        File spill = LittleFS.open(UPLINK_SPILL_PATH, "r");
+        if (!spill) {
+            uplinkSpillCount = 0;
+            uplinkSpillSent = 0;
         }
+        while (uplinkSpillSent < uplinkSpillCount) {
+            uint32_t remaining = uplinkSpillCount - uplinkSpillSent;
+            uint16_t count = (remaining < UPLINK_BATCH_SIZE) ? remaining : UPLINK_BATCH_SIZE;
+            if (!spill.seek(uplinkSpillSent * sizeof(UplinkEvent)) || 
+                spill.read((uint8_t *)events, count * sizeof(UplinkEvent)) != count * sizeof(UplinkEvent)) {
+                Serial.println("Uplink spill file damaged, discarded");
+                uplinkSpillSent = uplinkSpillCount;
+                break;
+            }
+            if (!postUplinkBatch(events, count)) {
+                spill.close();
+                return false;
+            }
+            uplinkSpillSent += count;
+        }
+        if (spill) {
+            spill.close();
+        }
+        LittleFS.remove(UPLINK_SPILL_PATH);
+        uplinkSpillCount = 0;
+        uplinkSpillSent = 0;
     }
-    if (last3AllZero) return false;
     
-    // Validate last 3 bytes (not all FFs)
-    bool last3AllFF = true;
-    for (int byteIndex = 4; byteIndex < 7; byteIndex++) {
-        if (uid[byteIndex] != 0xFF) {
-            last3AllFF = false;
-            break;
+    uint16_t count;
+    while ((count = peekUplinkEvents(events, UPLINK_BATCH_SIZE)) > 0) {
+        if (!postUplinkBatch(events, count)) {
+            return false;
         }
+        dropUplinkEvents(count);
     }
-    if (last3AllFF) return false;
-    
-    // Check for invalid first byte
-    if (uid[0] == 0x00) return false;
-    
     return true;
 }
 
 /**
- * @brief Validates 10-byte UID format
+ * @brief Brings up the WiFi station for an upload
  * 
- * @param uid Pointer to UID byte array
- * @return true if UID is valid, false otherwise
+ * @return true once associated with the connection stored by the menu
  * 
- * Validates triple-size UID format
+ * BSSID and channel of the last association skip the channel scan.
+ * If that access point is gone, they are forgotten and the next try
+ * scans all channels.
  */
-bool validate10ByteUID(uint8_t *uid) {
-    // Check for all zeros
-    bool allZero = true;
-    for (int byteIndex = 0; byteIndex < 10; byteIndex++) {
-        if (uid[byteIndex] != 0x00) {
-            allZero = false;
-            break;
-        }
+bool connectUplink() {
+    if (WiFi.status() == WL_CONNECTED) {
+        return true;
     }
-    if (allZero) return false;
-    
-    // Check for all FFs
-    bool allFF = true;
-    for (int byteIndex = 0; byteIndex < 10; byteIndex++) {
-        if (uid[byteIndex] != 0xFF) {
-            allFF = false;
-            break;
+    WifiCredentials credentials;
+    if (!getStoredWifi(credentials)) {
+        return false;
+    }
+    beginWifi(credentials);
+    unsigned long connectStart = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - connectStart >= UPLINK_CONNECT_TIMEOUT_MS) {
+            if (credentials.channel != 0) {
+                credentials.channel = 0;
+                saveWifiCredentials(credentials);
+            }
+            return false;
         }
+        vTaskDelay(pdMS_TO_TICKS(100));
     }
-    if (allFF) return false;
     
+    // Timestamps of later events, SNTP keeps running in the background
+    static bool clockStarted = false;
+    if (!clockStarted) {
+        configTime(0, 0, UPLINK_NTP_SERVER);
+        clockStarted = true;
+    }
     return true;
 }
 
-// ========== NFC CARD READING FUNCTION ==========
 /**
- * @brief Reads NFC card and extracts UID
+ * @brief Uplink task, pinned to UPLINK_TASK_CORE
  * 
- * @param uidBuffer Buffer to store extracted UID
- * @return Length of UID (4, 7, 10) or negative error code
- * 
- * Performs complete NFC card activation and validation
+ * The radio is switched on only when a batch is due: UPLINK_BATCH_SIZE
+ * events, the oldest event older than UPLINK_MAX_DELAY_MS or a spill
+ * file to drain. It is switched off again after the upload. Without a
+ * connection the ring is moved to LittleFS before it runs full.
+ * Right after boot it connects once to sync the clock and drain the
+ * spill file. The radio is left to the WiFi menu while it scans or
+ * connects.
  */
-int8_t readCard(uint8_t *uidBuffer) {
-    uint8_t responseBuffer[10] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 
-                                  0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    
-    // Activate Type A card and get raw response
-    int8_t rawResponseLength = nfc.activateTypeA(responseBuffer, 0);
-    
-    // Check for activation errors
-    if (rawResponseLength <= 0) {
-        return rawResponseLength;
+void uplinkTask(void *parameter) {
+    unsigned long lastFailure = 0;
+    bool failed = false;
+    WifiCredentials credentials;
+    bool bootConnect = getStoredWifi(credentials);
+    
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UPLINK_CHECK_INTERVAL_MS));
+        
+        UplinkEvent oldest;
+        uint16_t buffered = peekUplinkEvents(&oldest, 1) ? uplinkCount : 0;
+        bool due = bootConnect || uplinkSpillCount > 0 || buffered >= UPLINK_BATCH_SIZE || 
+                   (buffered > 0 && millis() - oldest.uptimeMs >= UPLINK_MAX_DELAY_MS);
+        
+        if (due && (!failed || millis() - lastFailure >= UPLINK_RETRY_MS)) {
+            uplinkBusy = true;
+        }
+        if (uplinkBusy && !wifiMenuUsesRadio()) {
+            bootConnect = false;
+            bool radioWasOn = (WiFi.status() == WL_CONNECTED);
+            failed = !(connectUplink() && flushUplinkEvents());
+            if (failed) {
+                lastFailure = millis();
+                Serial.println("Uplink deferred, events kept");
+            }
+            if (!radioWasOn) {
+                WiFi.disconnect(true);
+                WiFi.mode(WIFI_OFF);
+            }
+        }
+        uplinkBusy = false;
+        
+        if (uplinkCount >= UPLINK_SPILL_THRESHOLD) {
+            spillUplinkEvents();
+        }
     }
-    
-    // Validate response length
-    if (rawResponseLength != 4 && rawResponseLength != 7 && rawResponseLength != 10) {
-        return -3; // Invalid length error
+}
+
+/**
+ * @brief Counts this boot in Preferences
+ * 
+ * Called before the NFC task starts. Boot and sequence number identify
+ * an event across reboots, also for events spilled before a reboot.
+ */
+void loadUplinkBoot() {
+    Preferences preferences;
+    if (preferences.begin("uplink", false)) {
+        uplinkBoot = preferences.getUInt("boot", 0) + 1;
+        preferences.putUInt("boot", uplinkBoot);
+        preferences.end();
     }
-    
-    // Extract and validate ATQA (Answer To Request)
-    uint16_t atqaValue = (responseBuffer[1] << 8) | responseBuffer[0];
-    if (atqaValue == 0x0000 || atqaValue == 0xFFFF) {
-        return -3; // Invalid ATQA error
+}
+
+/**
+ * @brief Picks up events spilled before the last reboot
+ */
+void beginUplink() {
+    File spill = LittleFS.open(UPLINK_SPILL_PATH, "r");
+    if (spill) {
+        uplinkSpillCount = spill.size() / sizeof(UplinkEvent);
+        spill.close();
+        Serial.print("Uplink events from flash: ");
+        Serial.println(uplinkSpillCount);
     }
-    
-    // Validate SAK (Select Acknowledge)
-    uint8_t sakValue = responseBuffer[2];
-    bool isValidSAK = false;
-    
-    switch(sakValue) {
-        case 0x00: case 0x08: case 0x09: case 0x10: case 0x11:
-        case 0x18: case 0x20: case 0x28: case 0x88: case 0x89:
-            isValidSAK = true;
-            break;
+}
+
+// ========== NFC TASK ==========
+/**
+ * @brief Posts a card event to the UI queue
+ * 
+ * @param type Event type
+ * @param uid UID bytes (may be NULL for removal)
+ * @param uidLength Number of UID bytes
+ * @param cardType Card type (PN5180_CARD_UNKNOWN for removal)
+ * @param access Allow-list decision (ACCESS_NO_LIST for removal)
+ */
+void postNfcEvent(NfcEventType type, const uint8_t *uid, uint8_t uidLength, 
+                  PN5180CardType cardType, AccessDecision access) {
+    NfcEvent event;
+    event.type = type;
+    event.uidLength = uidLength;
+    event.cardType = cardType;
+    event.access = access;
+    memset(event.uid, 0, sizeof(event.uid));
+    if (uid != NULL) {
+        memcpy(event.uid, uid, uidLength);
     }
+    queueUplinkEvent(event, (type == NFC_EVENT_CARD_ARRIVED) ? nfcReadLatencyUs : 0);
     
-    if (!isValidSAK) {
-        return -3; // Invalid SAK error
+    // Never block the reader on a slow UI
+    if (xQueueSend(nfcEventQueue, &event, 0) != pdTRUE) {
+        Serial.println("NFC event queue full, event dropped");
+    } else if (uiTaskHandle != NULL) {
+        xTaskNotifyGive(uiTaskHandle);
     }
-    
-    // Process based on UID length
-    if (rawResponseLength == 4) {
-        // Validate 4-byte UID
-        if (!validate4ByteUID(&responseBuffer[3])) {
-            return -3;
+}
+
+/**
+ * @brief NFC reader task, pinned to NFC_TASK_CORE
+ * 
+ * Polls the PN5180 independent of button handling and ePaper refreshes.
+ * Card arrival and removal are posted as NfcEvent to nfcEventQueue.
+ */
+void nfcTask(void *parameter) {
+    bool firstRead = true;      // Boot-to-first-read metric not logged yet
+    unsigned long lastStatsPrint = millis();
+    uint8_t missedPolls = 0;    // Consecutive polls without the known card
+    
+    for (;;) {
+        // Periodic PN5180 command/timing statistics
+        if (NFC_STATS_INTERVAL_MS > 0 && millis() - lastStatsPrint >= NFC_STATS_INTERVAL_MS) {
+            lastStatsPrint = millis();
+            nfc.printStats(Serial);
         }
         
-        // Copy UID to output buffer
-        for (int byteIndex = 0; byteIndex < 4; byteIndex++) {
-            uidBuffer[byteIndex] = responseBuffer[3 + byteIndex];
+        if (currentMode != MODE_NFC) {
+            // Reader idle outside of NFC mode
+            if (lastValidLength > 0) {
+                lastValidLength = 0;
+                postNfcEvent(NFC_EVENT_CARD_REMOVED, NULL, 0, PN5180_CARD_UNKNOWN, ACCESS_NO_LIST);
+            }
+            missedPolls = 0;
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
         }
         
-        return 4;
-    }
-    else if (rawResponseLength == 7) {
-        // Validate 7-byte UID
-        if (!validate7ByteUID(&responseBuffer[3])) {
-            return -3;
+        // Known card still selectable, no full activation needed
+        if (lastValidLength > 0 && nfc.isCardPresent(lastValidUID, lastValidLength)) {
+            missedPolls = 0;
+            waitNextPoll(NFC_PRESENCE_INTERVAL_MS);
+            continue;
         }
         
-        // Copy UID to output buffer
-        for (int byteIndex = 0; byteIndex < 7; byteIndex++) {
-            uidBuffer[byteIndex] = responseBuffer[3 + byteIndex];
+        uint8_t uidBuffer[10] = {0};
+        unsigned long readStart = micros();
+        int8_t uidLength = readCard(uidBuffer, NFC_REQUEST_KIND);
+        if (uidLength < 0) {
+            uidLength = recoverReader(uidBuffer);
+        } else {
+            nfcFailures = 0;
         }
-        
-        return 7;
-    }
-    else if (rawResponseLength == 10) {
-        // Validate 10-byte UID
-        if (!validate10ByteUID(&responseBuffer[3])) {
-            return -3;
+        nfcReadLatencyUs = micros() - readStart;
+        if (firstRead) {
+            firstRead = false;
+            Serial.print("Boot to first NFC read: ");
+            Serial.print(millis());
+            Serial.println(" ms");
         }
         
-        // Copy UID to output buffer
-        for (int byteIndex = 0; byteIndex < 10; byteIndex++) {
-            uidBuffer[byteIndex] = responseBuffer[3 + byteIndex];
+        if (uidLength > 0) {
+            missedPolls = 0;
+            
+            // Report new card or different UID
+            if (uidLength != lastValidLength || 
+                memcmp(uidBuffer, lastValidUID, uidLength) != 0) {
+                nfcActivityTime = millis();
+                lastValidLength = uidLength;
+                memcpy(lastValidUID, uidBuffer, uidLength);
+                postNfcEvent(NFC_EVENT_CARD_ARRIVED, uidBuffer, uidLength, nfcCardType, 
+                             lookupAllowList(uidBuffer, uidLength));
+            }
+        } else {
+            // Debounce removal, a single missed poll keeps the card
+            if (lastValidLength > 0 && ++missedPolls >= NFC_REMOVAL_DEBOUNCE_POLLS) {
+                lastValidLength = 0;
+                missedPolls = 0;
+                nfcActivityTime = millis();
+                postNfcEvent(NFC_EVENT_CARD_REMOVED, NULL, 0, PN5180_CARD_UNKNOWN, ACCESS_NO_LIST);
+            }
+            
+            // Go to LPCD idle after NFC_IDLE_TIMEOUT_MS without activity, once the UI is settled
+            if (uidLength == 0 && lastValidLength == 0 && uiIdle && !uplinkBusy && 
+                WiFi.status() != WL_CONNECTED &&
+                millis() - nfcActivityTime >= NFC_IDLE_TIMEOUT_MS) {
+                bool cardWakeup = enterNfcIdle();
+                // Card or button woke us up, poll fast again
+                nfcActivityTime = millis();
+                nfcPollInterval = NFC_POLL_FAST_MS;
+                if (cardWakeup) {
+                    // Read the card without waiting
+                    continue;
+                }
+            }
         }
         
-        return 10;
+        waitNextPoll(nextPollInterval());
     }
-    
-    return -3; // General validation error
 }
 
-// ========== DISPLAY MODE MANAGEMENT ==========
 /**
- * @brief Updates display based on current system state
+ * @brief Applies a card event from the NFC task to the UI state
  * 
- * Controls which screen is shown based on mode and sub-mode
- * Prevents unnecessary screen refreshes
+ * @param event Event received from nfcEventQueue
  */
-void updateDisplay() {
-    // Check if display update is needed
-    if (!displayUpdateRequired && 
-        currentMode == lastDisplayedMode && 
-        currentWifiSubMode == lastWifiSubMode) {
-        return;
-    }
-    
-    // Select screen based on current mode
-    switch (currentMode) {
-        case MODE_NFC:
-            if (cardDetected) {
-                showUIDSmall(lastUID);
-            } else {
-                displayNoCardScreen();
-            }
-            break;
-            
-        case MODE_WIFI:
-            switch (currentWifiSubMode) {
-                case WIFI_SUB_NONE:
-                    displayWifiMainMenu();
-                    break;
-                case WIFI_SUB_SCAN:
-                    displayScanWifiScreen();
-                    break;
-                case WIFI_SUB_MANUAL:
-                    displayManualConnectScreen();
-                    break;
-            }
-            break;
+void handleNfcEvent(const NfcEvent &event) {
+    if (event.type == NFC_EVENT_CARD_ARRIVED) {
+        cardDetected = true;
+        cardUIDLength = event.uidLength;
+        memcpy(cardUID, event.uid, sizeof(cardUID));
+        cardType = event.cardType;
+        cardAccess = event.access;
+        displayUpdateRequired = true;
+        
+        char uidText[UID_TEXT_LENGTH];
+        formatUID(cardUID, cardUIDLength, uidText);
+        Serial.print("Card detected: ");
+        Serial.print(uidText);
+        Serial.print(" (");
+        Serial.print(PN5180CardTypeName(cardType));
+        Serial.print(") ");
+        Serial.println(accessDecisionText(cardAccess));
+    } else if (cardDetected) {
+        cardDetected = false;
+        cardUIDLength = 0;
+        displayUpdateRequired = true;
+        Serial.println("Card removed");
     }
-    
-    // Reset update flags
-    displayUpdateRequired = false;
-    lastDisplayedMode = currentMode;
-    lastWifiSubMode = currentWifiSubMode;
 }
 
 // ========== ARDUINO SETUP FUNCTION ==========
@@ -871,9 +2495,8 @@ void updateDisplay() {
  * Initializes all hardware components and system state
  */
 void setup() {
-    // Initialize serial communication
+    // Initialize serial communication, no wait: the DevKit has a UART bridge
     Serial.begin(115200);
-    delay(1000);
     
     // Print startup banner
     Serial.println(F("=================================="));
@@ -881,37 +2504,45 @@ void setup() {
     Serial.println(F("Enhanced WiFi Menu System"));
     Serial.println(F("=================================="));
     
-    // ========== BUTTON CONFIGURATION ==========
-    pinMode(MODE_BUTTON_PIN, INPUT_PULLUP);
-    pinMode(SELECT_BUTTON_PIN, INPUT_PULLUP);
+    // Brownout, watchdog or software reset: the panel still shows the last screen
+    esp_reset_reason_t resetReason = esp_reset_reason();
+    displayColdBoot = (resetReason == ESP_RST_POWERON || resetReason == ESP_RST_UNKNOWN);
+    Serial.print(F("Reset reason="));
+    Serial.print((int)resetReason);
+    Serial.println(displayColdBoot ? F(" (cold boot)") : F(" (warm restart)"));
     
-    // Attach interrupt handlers
-    attachInterrupt(digitalPinToInterrupt(MODE_BUTTON_PIN), 
-                    handleModeButtonInterrupt, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(SELECT_BUTTON_PIN), 
-                    handleSelectButtonInterrupt, FALLING);
+    // ========== BUTTON CONFIGURATION ==========
+    uiTaskHandle = xTaskGetCurrentTaskHandle();
+    beginButtons();
     
-    Serial.println("Buttons configured with interrupts");
+    Serial.println("Buttons configured with debounce timers");
     Serial.println("B1: GPIO14 (Mode/Confirm)");
     Serial.println("B2: GPIO27 (Select)");
     
-    // ========== DISPLAY INITIALIZATION ==========
-    display.init(115200, true, 2, false);
-    display.setRotation(1);
-    display.clearScreen();
-    displayInitialized = true;
-    
-    // Show startup screen
-    displayStartingScreen();
-    
     // ========== SPI BUS INITIALIZATION ==========
+    // Before the display task: SPIClass is set up once, later begin() calls
+    // of display.init() and nfc.begin() keep these pins
     SPI.begin(18, 19, 23); // SCK, MISO, MOSI pins
+    // PN5180 NSS high before the first ePaper transfer
+    nfc.begin();
+    nfc.setBusLock(lockSpiBus, unlockSpiBus);
+    
+    // ========== DISPLAY TASK START ==========
+    // The panel is initialized by the display task with its first frame
+    epdBusySemaphore = xSemaphoreCreateBinary();
+    spiBusMutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(displayTask, "displayTask", DISPLAY_TASK_STACK_SIZE, NULL, 
+                            DISPLAY_TASK_PRIORITY, &displayTaskHandle, DISPLAY_TASK_CORE);
+    
+    // Cold boot: startup screen (after the clear) renders while the PN5180 is set up
+    if (displayColdBoot) {
+        displayStartingScreen();
+    }
     
     // ========== NFC READER INITIALIZATION ==========
     Serial.println(F("----------------------------------"));
     Serial.println(F("Initializing PN5180..."));
     
-    nfc.begin();
     Serial.println(F("PN5180 Hard-Reset..."));
     nfc.reset();
     
@@ -929,13 +2560,13 @@ void setup() {
         Serial.println(F("Initialization failed!?"));
         
         // Display error screen
-        display.setFullWindow();
-        display.fillScreen(GxEPD_WHITE);
-        drawCenteredText("INIT ERROR", display.height() / 2 - 20, 
-                        &FreeMonoBold18pt7b, GxEPD_RED);
-        drawCenteredText("Restart device", display.height() / 2 + 20, 
-                        &FreeMonoBold12pt7b, GxEPD_BLACK);
-        display.display(true);
+        beginFrame();
+        addLabel("INIT ERROR", WIDGET_CENTERED, display.height() / 2 - 20, 
+                 &FreeMonoBold18pt7b, GxEPD_RED);
+        addLabel("Restart device", WIDGET_CENTERED, display.height() / 2 + 20, 
+                 &FreeMonoBold12pt7b, GxEPD_BLACK);
+        commitFrame();
+        waitForDisplayIdle();
         
         Serial.println(F("Press reset to restart..."));
         Serial.flush();
@@ -946,17 +2577,41 @@ void setup() {
     Serial.println(F("Enable RF field..."));
     nfc.setupRF();
     
+    // LPCD wake-up pin, calibration follows on the first idle (no card in the field)
+    pinMode(PN5180_IRQ_PIN, INPUT);
+    uint8_t irqPinConfig = 0;
+    nfc.readEEprom(IRQ_PIN_CONFIG, &irqPinConfig, 1);
+    nfcIrqWakeLevel = irqPinConfig & 0x01; // IRQ_POL: 1 = active high
+    
+    // ========== ALLOW-LIST INITIALIZATION ==========
+    beginAllowList();
+    
     // ========== SYSTEM READY ==========
     Serial.println(F("----------------------------------"));
     Serial.println(F("System initialization complete"));
     
     systemReady = true;
     
+    // ========== NFC TASK START ==========
+    // Card polling starts before the first NFC screen is rendered
+    loadUplinkBoot();
+    nfcEventQueue = xQueueCreate(NFC_EVENT_QUEUE_LENGTH, sizeof(NfcEvent));
+    nfcActivityTime = millis();
+    xTaskCreatePinnedToCore(nfcTask, "nfcTask", NFC_TASK_STACK_SIZE, NULL, 
+                            NFC_TASK_PRIORITY, &nfcTaskHandle, NFC_TASK_CORE);
+    
     // Set default mode and update display
     currentMode = MODE_NFC;
     displayUpdateRequired = true;
     updateDisplay();
     
+    // ========== UPLINK TASK START ==========
+    WiFi.persistent(false);  // Credentials are kept in Preferences
+    loadWifiCredentials();
+    beginUplink();
+    xTaskCreatePinnedToCore(uplinkTask, "uplinkTask", UPLINK_TASK_STACK_SIZE, NULL, 
+                            UPLINK_TASK_PRIORITY, &uplinkTaskHandle, UPLINK_TASK_CORE);
+    
     Serial.println(F("System ready!"));
     Serial.println(F("B1: Switch mode / Confirm / Exit"));
     Serial.println(F("B2: Select menu item"));
@@ -970,87 +2625,28 @@ void setup() {
  */
 void loop() {
     // ========== BUTTON EVENT PROCESSING ==========
-    // Handle Mode button short press
-    if (modeButtonPressed) {
-        modeButtonPressed = false;
-        handleModeButtonPress();
+    ButtonEvent buttonEvent;
+    while (xQueueReceive(buttonEventQueue, &buttonEvent, 0) == pdTRUE) {
+        // Any button restarts fast NFC polling
+        noteNfcActivity();
+        handleButtonEvent(buttonEvent);
     }
     
-    // Handle Mode button long press
-    if (modeButtonLongPressed) {
-        modeButtonLongPressed = false;
-        handleModeButtonLongPress();
+    // ========== NFC EVENT PROCESSING ==========
+    NfcEvent event;
+    while (xQueueReceive(nfcEventQueue, &event, 0) == pdTRUE) {
+        handleNfcEvent(event);
     }
     
-    // Handle Select button press
-    if (selectButtonPressed) {
-        selectButtonPressed = false;
-        handleSelectButtonPress();
-    }
-    
-    // ========== MODE-SPECIFIC PROCESSING ==========
-    switch (currentMode) {
-        case MODE_NFC: {
-            // NFC Card Reading Mode
-            uint8_t uidBuffer[10] = {0};
-            int8_t uidLength = readCard(uidBuffer);
-            
-            if (uidLength > 0) {
-                // Convert UID bytes to hex string
-                String newUID = "";
-                for (int byteIndex = 0; byteIndex < uidLength; byteIndex++) {
-                    if (uidBuffer[byteIndex] < 0x10) newUID += "0";
-                    newUID += String(uidBuffer[byteIndex], HEX);
-                    if (byteIndex < uidLength - 1) newUID += " ";
-                }
-                newUID.toUpperCase();
-                
-                // Update display if new card detected
-                if (!cardDetected || newUID != lastUID) {
-                    cardDetected = true;
-                    lastUID = newUID;
-                    displayUpdateRequired = true;
-                    Serial.print("Card detected: ");
-                    Serial.println(newUID);
-                }
-                
-            } else if (uidLength < 0) {
-                // Handle NFC reading errors
-                if (uidLength == -2 || uidLength == -3) {
-                    // Reset NFC reader on communication errors
-                    nfc.reset();
-                    delay(50);
-                    nfc.setupRF();
-                    delay(100);
-                }
-                
-                // Clear card detected state
-                if (cardDetected) {
-                    cardDetected = false;
-                    displayUpdateRequired = true;
-                    Serial.println("Card removed");
-                }
-            } else {
-                // No card present
-                if (cardDetected) {
-                    cardDetected = false;
-                    lastUID = "";
-                    displayUpdateRequired = true;
-                    Serial.println("Card removed");
-                }
-            }
-            
-            delay(200); // NFC polling interval
-            break;
-        }
-        
-        case MODE_WIFI: {
-            // WiFi Mode - minimal processing needed
-            delay(100); // Reduce CPU usage
-            break;
-        }
-    }
+    // ========== WIFI PROCESSING ==========
+    serviceWifiScan();
+    serviceWifiConnect();
     
     // ========== DISPLAY UPDATE ==========
     updateDisplay();
+    uiIdle = !displayUpdateRequired && displayIdle() && buttonsIdle() && 
+             uxQueueMessagesWaiting(buttonEventQueue) == 0;
+    
+    // Sleep until the next button or NFC event, WiFi is serviced every UI_POLL_INTERVAL_MS
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UI_POLL_INTERVAL_MS));
 }